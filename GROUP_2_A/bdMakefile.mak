@@ -1,16 +1,19 @@
 CC = gcc
+LDLIBS = -pthread
 
-SOURCES = bdmain.c bdgraph.c
+SOURCES = bdmain.c
 
 TARGET = bdprogram
 
 run: $(TARGET)
 	echo "links.txt\nhttp://example.com\nhttp://example.com/blog/post5\nno" | ./$(TARGET)
 
-$(TARGET): $(SOURCES)
-	$(CC) $(SOURCES) -o $(TARGET)
+include graphlib.mak
 
-clean:
+$(TARGET): $(SOURCES) $(LIB)
+	$(CC) $(SOURCES) $(LIB) -o $(TARGET) $(LDLIBS)
+
+clean: lib-clean
 	rm -f $(TARGET)
 
-.PHONY: run clean
+.PHONY: run clean lib-clean
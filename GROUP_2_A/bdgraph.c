@@ -1,223 +1,159 @@
+#include <unistd.h>
 #include "bdgraph.h"
 
-Graph* createGraph(int vertices) {
-    Graph* graph = (Graph*)malloc(sizeof(Graph));
-    graph->numVertices = vertices;
-    graph->nodes = (Node*)malloc(vertices * sizeof(Node));
+// Caches up to capacity bidirectionalSearch answers, replacing any
+// existing cache
+void enablePathCache(Graph* graph, int capacity) {
+    freePathCache(graph->pathCache);
+    graph->pathCache = createPathCache(capacity);
+}
 
-    graph->adjMatrix = (int**)malloc(vertices * sizeof(int*));
+SearchState* createSearchState(int vertices) {
+    SearchState* state = (SearchState*)malloc(sizeof(SearchState));
+    state->visited = (int*)calloc(vertices, sizeof(int));
+    state->parent = (int*)malloc(vertices * sizeof(int));
+    state->distance = (int*)malloc(vertices * sizeof(int));
+    state->queue = (int*)malloc(vertices * sizeof(int));
+    state->front = 0;
+    state->rear = 0;
+    state->epoch = 1;
+    state->numVertices = vertices;
+    state->readahead = 0;
+    state->neighbours = NULL;
+    state->decoded = NULL;
+    state->decodedCapacity = 0;
+    
     for (int i = 0; i < vertices; i++) {
-        graph->adjMatrix[i] = (int*)calloc(vertices, sizeof(int));
-        graph->nodes[i].vertex = i;
-        graph->nodes[i].url = NULL;
-        graph->nodes[i].edges = NULL;
-        graph->nodes[i].numEdges = 0;
+        state->distance[i] = INT_MAX;
+        state->parent[i] = -1;
     }
+    
+    return state;
+}
 
-    return graph;
+// Forgets the previous search without touching the arrays: a vertex only
+// counts as visited while its stamp matches the current epoch
+void resetSearchState(SearchState* state) {
+    state->front = 0;
+    state->rear = 0;
+    state->readahead = 0;
+    if (++state->epoch == INT_MAX) {
+        memset(state->visited, 0, state->numVertices * sizeof(int));
+        state->epoch = 1;
+    }
 }
 
-void addEdge(Graph* graph, int src, int dest, int weight) {
-    Edge* edge = (Edge*)malloc(sizeof(Edge));
-    edge->dest = dest;
-    edge->weight = weight;
+void freeSearchState(SearchState* state) {
+    free(state->visited);
+    free(state->parent);
+    free(state->distance);
+    free(state->queue);
+    free(state->neighbours);
+    free(state->decoded);
+    free(state);
+}
 
-    graph->nodes[src].edges = (Edge*)realloc(graph->nodes[src].edges, 
-        (graph->nodes[src].numEdges + 1) * sizeof(Edge));
-    graph->nodes[src].edges[graph->nodes[src].numEdges++] = *edge;
-    free(edge);
+static int isVisited(const SearchState* state, int vertex) {
+    return state->visited[vertex] == state->epoch;
+}
 
-    graph->adjMatrix[src][dest] = weight;
+static void seedSearch(SearchState* state, int vertex) {
+    state->queue[state->rear++] = vertex;
+    state->visited[vertex] = state->epoch;
+    state->parent[vertex] = -1;
+    state->distance[vertex] = 0;
 }
 
-int findVertexByUrl(Graph* graph, const char* url) {
-    for (int i = 0; i < graph->numVertices; i++) {
-        if (graph->nodes[i].url && strcmp(graph->nodes[i].url, url) == 0) {
-            return i;
-        }
+// Lists of a disk-resident graph are copied into a buffer sized once for
+// the longest list
+static DiskEdge* diskBuffer(DiskGraph* disk, SearchState* state) {
+    if (!state->neighbours) {
+        state->neighbours = (DiskEdge*)malloc((disk->maxDegree + 1) * sizeof(DiskEdge));
+        if (!state->neighbours) printf("Error: Not enough memory for a neighbour list\n");
     }
-    return -1;
+    return state->neighbours;
 }
 
-void processUrlFile(Graph* graph, const char* filename) {
-    FILE* file = fopen(filename, "r");
-    if (!file) {
-        printf("Error: Cannot open file '%s'\n", filename);
-        return;
+// Pages the list of vertex in from the adjacency file, then asks for the
+// lists of the next DISK_READAHEAD queued vertices so they load while the
+// search works through the ones before them
+static int diskStep(DiskGraph* disk, SearchState* state, int vertex, int forward) {
+    if (!diskBuffer(disk, state)) return 0;
+    int degree = diskGraphNeighbours(disk, vertex, forward, state->neighbours);
+    if (degree < 0) {
+        printf("Error: Could not read the neighbours of vertex %d\n", vertex);
+        return 0;
     }
-
-    char fromUrl[MAX_URL_LENGTH], toUrl[MAX_URL_LENGTH];
-    int weight;
-    int nextVertex = 0;
-    char line[MAX_URL_LENGTH * 2 + 50];
-
-    printf("Starting to read file '%s'...\n", filename);
-
-    while (fgets(line, sizeof(line), file)) {
-        line[strcspn(line, "\n")] = '\0';
-        
-        char* fromUrlToken = strtok(line, ",");
-        char* toUrlToken = strtok(NULL, ",");
-        char* weightToken = strtok(NULL, ",");
-        
-        if (fromUrlToken && toUrlToken && weightToken) {
-            weight = atoi(weightToken);
-            strncpy(fromUrl, fromUrlToken, MAX_URL_LENGTH - 1);
-            strncpy(toUrl, toUrlToken, MAX_URL_LENGTH - 1);
-            fromUrl[MAX_URL_LENGTH - 1] = '\0';
-            toUrl[MAX_URL_LENGTH - 1] = '\0';
-            
-            if (strlen(fromUrl) >= MAX_URL_LENGTH || strlen(toUrl) >= MAX_URL_LENGTH) {
-                printf("Warning: URL too long, skipping line\n");
-                continue;
-            }
-            
-            if (weight < 0) {
-                printf("Warning: Negative weight found, using absolute value\n");
-                weight = abs(weight);
-            }
-            
-            int fromIndex = findVertexByUrl(graph, fromUrl);
-            if (fromIndex == -1) {
-                if (nextVertex >= MAX_VERTICES) {
-                    printf("Error: Maximum number of vertices reached\n");
-                    break;
-                }
-                fromIndex = nextVertex++;
-                graph->nodes[fromIndex].url = strdup(fromUrl);
-                printf("Created new vertex for %s at index %d\n", fromUrl, fromIndex);
-            }
-
-            int toIndex = findVertexByUrl(graph, toUrl);
-            if (toIndex == -1) {
-                if (nextVertex >= MAX_VERTICES) {
-                    printf("Error: Maximum number of vertices reached\n");
-                    break;
-                }
-                toIndex = nextVertex++;
-                graph->nodes[toIndex].url = strdup(toUrl);
-                printf("Created new vertex for %s at index %d\n", toUrl, toIndex);
-            }
-
-            addEdge(graph, fromIndex, toIndex, weight);
-            printf("Added edge: %s -> %s (Weight: %d)\n", fromUrl, toUrl, weight);
+    for (int j = 0; j < degree; j++) {
+        int i = state->neighbours[j].dest;
+        if (state->neighbours[j].weight && !isVisited(state, i)) {
+            state->queue[state->rear++] = i;
+            state->visited[i] = state->epoch;
+            state->parent[i] = vertex;
+            state->distance[i] = state->distance[vertex] + 1;
         }
     }
-    
-    fclose(file);
-}
 
-void freeGraph(Graph* graph) {
-    if (!graph) return;
-    
-    for (int i = 0; i < graph->numVertices; i++) {
-        free(graph->adjMatrix[i]);
-        free(graph->nodes[i].url);
-        free(graph->nodes[i].edges);
+    int from = state->readahead > state->front ? state->readahead : state->front;
+    int until = state->rear < state->front + DISK_READAHEAD ?
+                state->rear : state->front + DISK_READAHEAD;
+    if (until > from) {
+        diskGraphReadahead(disk, state->queue + from, until - from, forward);
+        state->readahead = until;
     }
-    free(graph->adjMatrix);
-    free(graph->nodes);
-    free(graph);
+    return degree;
 }
 
-void printWeightedEdgeList(Graph* graph) {
-    printf("\n=== Weighted Edge List ===\n");
-    printf("From URL -> To URL (Weight)\n");
-    printf("----------------------------------------\n");
-    for (int i = 0; i < graph->numVertices; i++) {
-        if (graph->nodes[i].url) {
-            for (int j = 0; j < graph->nodes[i].numEdges; j++) {
-                int destIndex = graph->nodes[i].edges[j].dest;
-                printf("%-30s -> %-30s (Weight: %d)\n",
-                    graph->nodes[i].url,
-                    graph->nodes[destIndex].url,
-                    graph->nodes[i].edges[j].weight);
-            }
-        }
-    }
-}
-
-void printAdjacencyList(Graph* graph) {
-    printf("\n=== Weighted Adjacency List ===\n");
-    printf("URL -> [Destination URLs]\n");
-    printf("----------------------------------------\n");
-    for (int i = 0; i < graph->numVertices; i++) {
-        if (graph->nodes[i].url) {
-            printf("%-30s ->", graph->nodes[i].url);
-            for (int j = 0; j < graph->nodes[i].numEdges; j++) {
-                int destIndex = graph->nodes[i].edges[j].dest;
-                printf(" %s (%d)", 
-                    graph->nodes[destIndex].url,
-                    graph->nodes[i].edges[j].weight);
-            }
-            printf("\n");
+// Compressed lists are decoded a whole vertex at a time with adjDecode into
+// a buffer sized for the longest list. Returns the dests half; the weights
+// follow decodedCapacity entries later.
+static int* decodeBuffer(const CompressedAdjacency* adj, SearchState* state) {
+    if (state->decodedCapacity <= adj->maxDegree) {
+        int capacity = adj->maxDegree + 1;
+        int* grown = (int*)realloc(state->decoded, 2 * (size_t)capacity * sizeof(int));
+        if (!grown) {
+            printf("Error: Not enough memory for a neighbour list\n");
+            return NULL;
         }
+        state->decoded = grown;
+        state->decodedCapacity = capacity;
     }
+    return state->decoded;
 }
 
-void printAdjacencyMatrix(Graph* graph) {
-    printf("\n=== Weighted Adjacency Matrix ===\n");
-    printf("%5s", "");
-    for (int i = 0; i < graph->numVertices; i++) {
-        if (graph->nodes[i].url) {
-            printf("%5d ", i);
-        }
-    }
-    printf("\n%5s", "");
-    for (int i = 0; i < graph->numVertices; i++) {
-        if (graph->nodes[i].url) {
-            printf("------");
-        }
-    }
-    printf("\n");
-    for (int i = 0; i < graph->numVertices; i++) {
-        if (graph->nodes[i].url) {
-            printf("[%3d] ", i);
-            for (int j = 0; j < graph->numVertices; j++) {
-                if (graph->nodes[j].url) {
-                    printf("%5d ", graph->adjMatrix[i][j]);
-                }
+// Expands one vertex and returns how many edges or matrix cells it looked at
+int bfsStep(Graph* graph, SearchState* state, int vertex, int forward) {
+    if (graph->disk) return diskStep(graph->disk, state, vertex, forward);
+    if (graph->outAdj) {
+        // Decode the neighbour list instead of scanning a row or column of
+        // the matrix
+        const CompressedAdjacency* adj = forward ? graph->outAdj : graph->inAdj;
+        int* dests = decodeBuffer(adj, state);
+        if (!dests) return 0;
+        int* weights = dests + state->decodedCapacity;
+        int degree = adjDecode(adj, vertex, dests, weights);
+        for (int j = 0; j < degree; j++) {
+            int i = dests[j];
+            if (weights[j] && !isVisited(state, i)) {
+                state->queue[state->rear++] = i;
+                state->visited[i] = state->epoch;
+                state->parent[i] = vertex;
+                state->distance[i] = state->distance[vertex] + 1;
             }
-            printf("\n");
         }
+        return degree;
     }
-}
-
-SearchState* createSearchState(int vertices) {
-    SearchState* state = (SearchState*)malloc(sizeof(SearchState));
-    state->visited = (int*)calloc(vertices, sizeof(int));
-    state->parent = (int*)malloc(vertices * sizeof(int));
-    state->distance = (int*)malloc(vertices * sizeof(int));
-    state->queue = (int*)malloc(vertices * sizeof(int));
-    state->front = 0;
-    state->rear = 0;
     
-    for (int i = 0; i < vertices; i++) {
-        state->distance[i] = INT_MAX;
-        state->parent[i] = -1;
-    }
-    
-    return state;
-}
-
-void freeSearchState(SearchState* state) {
-    free(state->visited);
-    free(state->parent);
-    free(state->distance);
-    free(state->queue);
-    free(state);
-}
-
-void bfsStep(Graph* graph, SearchState* state, int vertex, int forward) {
     for (int i = 0; i < graph->numVertices; i++) {
         int hasEdge = forward ? graph->adjMatrix[vertex][i] : graph->adjMatrix[i][vertex];
-        if (hasEdge && !state->visited[i]) {
+        if (hasEdge && !isVisited(state, i)) {
             state->queue[state->rear++] = i;
-            state->visited[i] = 1;
+            state->visited[i] = state->epoch;
             state->parent[i] = vertex;
             state->distance[i] = state->distance[vertex] + 1;
         }
     }
+    return graph->numVertices;
 }
 
 Path* reconstructPath(SearchState* forward, SearchState* backward, 
@@ -247,7 +183,104 @@ Path* reconstructPath(SearchState* forward, SearchState* backward,
     return path;
 }
 
-Path* bidirectionalSearch(Graph* graph, const char* source_url, const char* target_url) {
+// Runs both frontiers from whatever the two states were seeded with and
+// returns the best meeting vertex, or -1 if the searches never touch, ctx
+// stopped them first or the best path is longer than maxHops (0 = no
+// cap). With a cap the forward side expands vertices up to half of it,
+// rounded up, and the backward side the rest; both then run until empty
+// so no path within the cap is missed. With verbose set every step is
+// traced.
+static int searchFromSeeds(Graph* graph, SearchState* forward, SearchState* backward,
+                           int verbose, int* iterations, int maxHops, QueryContext* ctx) {
+    char urlBuf[MAX_URL_LENGTH];
+    int intersection = -1;
+    int min_path_length = INT_MAX;
+    int forwardHops = maxHops > 0 ? (maxHops + 1) / 2 : INT_MAX;
+    int backwardHops = maxHops > 0 ? maxHops / 2 : INT_MAX;
+    *iterations = 0;
+
+    if (verbose) {
+        printf("\nSearch Progress:\n");
+        printf("----------------\n");
+    }
+
+    while (maxHops > 0 ? (forward->front < forward->rear || backward->front < backward->rear)
+                       : (forward->front < forward->rear && backward->front < backward->rear)) {
+        if (queryExpired(ctx)) return -1;
+        (*iterations)++;
+        if (verbose) printf("\nIteration %d:\n", *iterations);
+
+        // Forward search step
+        int scanned = 0;
+        if (forward->front < forward->rear) {
+            int current_forward = forward->queue[forward->front++];
+            if (verbose) {
+                printf("Forward frontier: %s\n", getVertexUrl(graph, current_forward, urlBuf));
+            }
+            if (forward->distance[current_forward] < forwardHops) {
+                scanned += bfsStep(graph, forward, current_forward, 1);
+            }
+
+            if (isVisited(backward, current_forward)) {
+                int path_length = forward->distance[current_forward] +
+                                backward->distance[current_forward];
+                if (path_length < min_path_length) {
+                    min_path_length = path_length;
+                    intersection = current_forward;
+                    if (verbose) {
+                        printf("Found potential meeting point at: %s (distance: %d)\n",
+                               getVertexUrl(graph, intersection, urlBuf), path_length);
+                    }
+                }
+            }
+        }
+
+        if (backward->front < backward->rear) {
+            int current_backward = backward->queue[backward->front++];
+            if (verbose) {
+                printf("Backward frontier: %s\n", getVertexUrl(graph, current_backward, urlBuf));
+            }
+            if (backward->distance[current_backward] < backwardHops) {
+                scanned += bfsStep(graph, backward, current_backward, 0);
+            }
+
+            if (isVisited(forward, current_backward)) {
+                int path_length = forward->distance[current_backward] +
+                                backward->distance[current_backward];
+                if (path_length < min_path_length) {
+                    min_path_length = path_length;
+                    intersection = current_backward;
+                    if (verbose) {
+                        printf("Found potential meeting point at: %s (distance: %d)\n",
+                               getVertexUrl(graph, intersection, urlBuf), path_length);
+                    }
+                }
+            }
+        }
+        if (ctx) {
+            ctx->settled += 2;
+            ctx->scanned += scanned;
+        }
+    }
+
+    if (maxHops > 0 && min_path_length > maxHops) return -1;
+    return intersection;
+}
+
+// Resets both states, seeds them with source and target and searches
+static int meetInMiddle(Graph* graph, SearchState* forward, SearchState* backward,
+                        int source, int target, int verbose, int* iterations,
+                        QueryContext* ctx) {
+    resetSearchState(forward);
+    resetSearchState(backward);
+    seedSearch(forward, source);
+    seedSearch(backward, target);
+    return searchFromSeeds(graph, forward, backward, verbose, iterations, 0, ctx);
+}
+
+static Path* searchSnapshot(Graph* graph, const char* source_url, const char* target_url,
+                            QueryContext* ctx) {
+    char urlBuf[MAX_URL_LENGTH];
     int source = findVertexByUrl(graph, source_url);
     int target = findVertexByUrl(graph, target_url);
     
@@ -256,73 +289,66 @@ Path* bidirectionalSearch(Graph* graph, const char* source_url, const char* targ
         return NULL;
     }
     
-    printf("\n=== Starting Bidirectional Search ===\n");
-    printf("Source URL: %s (Node %d)\n", source_url, source);
-    printf("Target URL: %s (Node %d)\n", target_url, target);
-    
-    SearchState* forward = createSearchState(graph->numVertices);
-    SearchState* backward = createSearchState(graph->numVertices);
-    
-    forward->queue[forward->rear++] = source;
-    forward->visited[source] = 1;
-    forward->distance[source] = 0;
-    
-    backward->queue[backward->rear++] = target;
-    backward->visited[target] = 1;
-    backward->distance[target] = 0;
-    
-    int intersection = -1;
-    int min_path_length = INT_MAX;
-    int iterations = 0;
-    
-    printf("\nSearch Progress:\n");
-    printf("----------------\n");
+    // Pairs the reachability index rules out need no search at all
+    if (graph->reachIndex && !reachIndexMayReach(graph->reachIndex, source, target)) {
+        printf("\n=== Bidirectional Search Skipped ===\n");
+        printf("No path found between %s and %s (different components, unreachable)\n",
+               source_url, target_url);
+        return NULL;
+    }
     
-    while (forward->front < forward->rear && backward->front < backward->rear) {
-        iterations++;
-        printf("\nIteration %d:\n", iterations);
-        
-        // Forward search step
-        int current_forward = forward->queue[forward->front++];
-        printf("Forward frontier: %s\n", graph->nodes[current_forward].url);
-        bfsStep(graph, forward, current_forward, 1);
-        
-        if (backward->visited[current_forward]) {
-            int path_length = forward->distance[current_forward] + 
-                            backward->distance[current_forward];
-            if (path_length < min_path_length) {
-                min_path_length = path_length;
-                intersection = current_forward;
-                printf("Found potential meeting point at: %s (distance: %d)\n", 
-                       graph->nodes[intersection].url, path_length);
+    if (graph->pathCache) {
+        int* cached;
+        int length;
+        if (pathCacheLookup(graph->pathCache, source, target, graph->version,
+                            &cached, &length)) {
+            printf("\n=== Bidirectional Search (cached) ===\n");
+            if (length == 0) {
+                printf("No path found between %s and %s\n", source_url, target_url);
+                return NULL;
             }
-        }
-        
-        int current_backward = backward->queue[backward->front++];
-        printf("Backward frontier: %s\n", graph->nodes[current_backward].url);
-        bfsStep(graph, backward, current_backward, 0);
-        
-        if (forward->visited[current_backward]) {
-            int path_length = forward->distance[current_backward] + 
-                            backward->distance[current_backward];
-            if (path_length < min_path_length) {
-                min_path_length = path_length;
-                intersection = current_backward;
-                printf("Found potential meeting point at: %s (distance: %d)\n", 
-                       graph->nodes[intersection].url, path_length);
+            Path* result = (Path*)malloc(sizeof(Path));
+            result->path = cached;
+            result->length = length;
+            printf("Path found: ");
+            for (int i = 0; i < result->length; i++) {
+                printf("%s", getVertexUrl(graph, result->path[i], urlBuf));
+                if (i < result->length - 1) printf(" -> ");
             }
+            printf("\nNumber of hops: %d\n", result->length - 1);
+            return result;
         }
     }
     
+    printf("\n=== Starting Bidirectional Search ===\n");
+    printf("Source URL: %s (Node %d)\n", source_url, originalVertexId(graph, source));
+    printf("Target URL: %s (Node %d)\n", target_url, originalVertexId(graph, target));
+    
+    size_t searchBytes = 2 * (sizeof(SearchState) + 4 * (size_t)graph->numVertices * sizeof(int));
+    if (!memReserve(&graph->memory, MEM_SEARCH, searchBytes)) {
+        printf("Error: Search state would exceed the memory budget\n");
+        return NULL;
+    }
+    SearchState* forward = createSearchState(graph->numVertices);
+    SearchState* backward = createSearchState(graph->numVertices);
+    
+    int iterations;
+    int intersection = meetInMiddle(graph, forward, backward, source, target, 1, &iterations,
+                                    ctx);
+    
+    // A stopped search has no answer, so nothing is cached either
     Path* result = NULL;
-    if (intersection != -1) {
+    if (ctx && ctx->status != QUERY_OK) {
+        printf("\n=== Bidirectional Search Stopped ===\n");
+        printQueryStopped(ctx);
+    } else if (intersection != -1) {
         result = reconstructPath(forward, backward, source, target, intersection);
         printf("\n=== Bidirectional Search Complete ===\n");
-        printf("Meeting point: %s\n", graph->nodes[intersection].url);
+        printf("Meeting point: %s\n", getVertexUrl(graph, intersection, urlBuf));
         printf("Total iterations: %d\n", iterations);
         printf("Path found: ");
         for (int i = 0; i < result->length; i++) {
-            printf("%s", graph->nodes[result->path[i]].url);
+            printf("%s", getVertexUrl(graph, result->path[i], urlBuf));
             if (i < result->length - 1) printf(" -> ");
         }
         printf("\nNumber of hops: %d\n", result->length - 1);
@@ -332,15 +358,612 @@ Path* bidirectionalSearch(Graph* graph, const char* source_url, const char* targ
         printf("Total iterations: %d\n", iterations);
     }
     
+    if (graph->pathCache && (!ctx || ctx->status == QUERY_OK)) {
+        pathCacheStore(graph->pathCache, source, target, graph->version,
+                       result ? result->path : NULL, result ? result->length : 0);
+    }
+    
     freeSearchState(forward);
     freeSearchState(backward);
+    memRelease(&graph->memory, MEM_SEARCH, searchBytes);
     
     return result;
 }
 
+// Holds the read lock for the whole search, so edge updates applied from
+// another thread are seen either completely or not at all
+Path* bidirectionalSearch(Graph* graph, const char* source_url, const char* target_url) {
+    return bidirectionalSearchWithContext(graph, source_url, target_url, NULL);
+}
+
+// As bidirectionalSearch, but gives up once ctx expires. NULL is then
+// returned with ctx->status saying why, so it is not mistaken for "no path".
+Path* bidirectionalSearchWithContext(Graph* graph, const char* source_url,
+                                     const char* target_url, QueryContext* ctx) {
+    if (ctx) startQuery(ctx);
+    pthread_rwlock_rdlock(&graph->lock);
+    Path* result = searchSnapshot(graph, source_url, target_url, ctx);
+    pthread_rwlock_unlock(&graph->lock);
+    return result;
+}
+
+// One line of a pairs file and, once a worker has answered it, the result
+typedef struct BatchQuery {
+    char* source;
+    char* target;
+    int* path;
+    int length;         // vertices on the path, 0 if none, -1 for unknown URLs
+    QueryStatus status; // why the search stopped before answering, if it did
+    int done;
+} BatchQuery;
+
+typedef struct BatchRun {
+    Graph* graph;
+    const QueryContext* limits;
+    BatchQuery* queries;
+    int numQueries;
+    int nextQuery;
+    int nextToPrint;
+    pthread_mutex_t lock;
+} BatchRun;
+
+// Each worker owns one pair of search states for the whole batch
+typedef struct BatchWorker {
+    BatchRun* run;
+    SearchState* forward;
+    SearchState* backward;
+} BatchWorker;
+
+static void answerQuery(BatchWorker* worker, BatchQuery* query) {
+    Graph* graph = worker->run->graph;
+    int source = findVertexByUrl(graph, query->source);
+    int target = findVertexByUrl(graph, query->target);
+    query->path = NULL;
+    query->length = 0;
+
+    if (source == -1 || target == -1) {
+        query->length = -1;
+        return;
+    }
+    if (graph->reachIndex && !reachIndexMayReach(graph->reachIndex, source, target)) return;
+    if (graph->pathCache && pathCacheLookup(graph->pathCache, source, target, graph->version,
+                                            &query->path, &query->length)) {
+        return;
+    }
+
+    // Every query gets the full limits to itself but shares the run's
+    // cancel flag
+    QueryContext ctx;
+    startChildQuery(&ctx, worker->run->limits);
+    int iterations;
+    int intersection = meetInMiddle(graph, worker->forward, worker->backward,
+                                    source, target, 0, &iterations, &ctx);
+    if (ctx.status != QUERY_OK) {
+        query->status = ctx.status;
+        return;
+    }
+    if (intersection != -1) {
+        Path* path = reconstructPath(worker->forward, worker->backward, source, target,
+                                     intersection);
+        query->path = path->path;
+        query->length = path->length;
+        free(path);
+    }
+    if (graph->pathCache) {
+        pathCacheStore(graph->pathCache, source, target, graph->version,
+                       query->path, query->length);
+    }
+}
+
+static void printBatchQuery(Graph* graph, BatchQuery* query) {
+    char urlBuf[MAX_URL_LENGTH];
+    if (query->length < 0) {
+        printf("%s -> %s: unknown URL\n", query->source, query->target);
+        return;
+    }
+    if (query->status != QUERY_OK) {
+        printf("%s -> %s: %s\n", query->source, query->target, queryStatusName(query->status));
+        return;
+    }
+    if (query->length == 0) {
+        printf("%s -> %s: no path\n", query->source, query->target);
+        return;
+    }
+    printf("%s -> %s: %d hops:", query->source, query->target, query->length - 1);
+    for (int i = 0; i < query->length; i++) {
+        printf(" %s%s", i > 0 ? "-> " : "", getVertexUrl(graph, query->path[i], urlBuf));
+    }
+    printf("\n");
+}
+
+// Whoever completes a query prints every answered query that is next in
+// input order, so results stream out while later ones are still running
+static void* batchWorker(void* arg) {
+    BatchWorker* worker = (BatchWorker*)arg;
+    BatchRun* run = worker->run;
+
+    while (1) {
+        pthread_mutex_lock(&run->lock);
+        int q = run->nextQuery++;
+        pthread_mutex_unlock(&run->lock);
+        if (q >= run->numQueries) break;
+
+        answerQuery(worker, &run->queries[q]);
+
+        pthread_mutex_lock(&run->lock);
+        run->queries[q].done = 1;
+        while (run->nextToPrint < run->numQueries && run->queries[run->nextToPrint].done) {
+            BatchQuery* ready = &run->queries[run->nextToPrint++];
+            printBatchQuery(run->graph, ready);
+            free(ready->path);
+            ready->path = NULL;
+        }
+        fflush(stdout);
+        pthread_mutex_unlock(&run->lock);
+    }
+    return NULL;
+}
+
+// Reads "SOURCE TARGET" pairs, one per line; blank lines and lines
+// starting with '#' are skipped
+static int readQueryPairs(const char* filename, BatchQuery** queries) {
+    FILE* file = fopen(filename, "r");
+    if (!file) {
+        printf("Error: Could not open pairs file '%s'\n", filename);
+        return -1;
+    }
+
+    char line[MAX_URL_LENGTH * 2 + 50];
+    int count = 0, capacity = 64, lineNumber = 0;
+    *queries = (BatchQuery*)malloc(capacity * sizeof(BatchQuery));
+    while (*queries && fgets(line, sizeof(line), file)) {
+        lineNumber++;
+        char* source = strtok(line, " \t\r\n");
+        char* target = strtok(NULL, " \t\r\n");
+        if (!source || source[0] == '#') continue;
+        if (!target) {
+            printf("Warning: Line %d of '%s' has no target URL\n", lineNumber, filename);
+            continue;
+        }
+        if (count == capacity) {
+            capacity *= 2;
+            BatchQuery* grown = (BatchQuery*)realloc(*queries, capacity * sizeof(BatchQuery));
+            if (!grown) break;
+            *queries = grown;
+        }
+        BatchQuery* query = &(*queries)[count];
+        memset(query, 0, sizeof(BatchQuery));
+        query->source = strdup(source);
+        query->target = strdup(target);
+        if (!query->source || !query->target) {
+            free(query->source);
+            free(query->target);
+            break;
+        }
+        count++;
+    }
+    fclose(file);
+
+    if (!*queries) return -1;
+    return count;
+}
+
+// Answers every pair in filename on up to numThreads threads (0 = one per
+// core) against a single snapshot of the graph. Search state is allocated
+// once per thread and reset by epoch between queries, so each query costs
+// only what it visits. limits, if given, applies to each query on its own,
+// and a cancelQuery on it from another thread stops the whole run.
+// Returns the number of queries answered, or -1.
+int batchShortestPaths(Graph* graph, const char* filename, int numThreads,
+                       const QueryContext* limits) {
+    BatchQuery* queries;
+    int numQueries = readQueryPairs(filename, &queries);
+    if (numQueries < 0) return -1;
 
+    if (numThreads <= 0) numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (numThreads <= 0) numThreads = 1;
+    if (numThreads > numQueries) numThreads = numQueries > 0 ? numQueries : 1;
 
-void printPathDetails(Graph* graph, Path* path) {
+    // Threads that would not fit in the budget are simply not started
+    size_t workerBytes = 2 * (sizeof(SearchState) + 4 * (size_t)graph->numVertices * sizeof(int));
+    BatchWorker* workers = (BatchWorker*)calloc(numThreads, sizeof(BatchWorker));
+    int numWorkers = 0;
+    while (workers && numWorkers < numThreads &&
+           memReserve(&graph->memory, MEM_SEARCH, workerBytes)) {
+        workers[numWorkers].forward = createSearchState(graph->numVertices);
+        workers[numWorkers].backward = createSearchState(graph->numVertices);
+        numWorkers++;
+    }
+    if (numWorkers == 0) {
+        printf("Error: Search state would exceed the memory budget\n");
+        for (int i = 0; i < numQueries; i++) {
+            free(queries[i].source);
+            free(queries[i].target);
+        }
+        free(queries);
+        free(workers);
+        return -1;
+    }
+
+    QueryContext unlimited;
+    initQueryContext(&unlimited);
+    BatchRun run;
+    run.graph = graph;
+    run.limits = limits ? limits : &unlimited;
+    run.queries = queries;
+    run.numQueries = numQueries;
+    run.nextQuery = 0;
+    run.nextToPrint = 0;
+    pthread_mutex_init(&run.lock, NULL);
+
+    printf("\n=== Batch Shortest Paths ===\n");
+    printf("Answering %d queries on %d threads\n", numQueries, numWorkers);
+    fflush(stdout);
+
+    pthread_rwlock_rdlock(&graph->lock);
+    pthread_t threads[numWorkers];
+    int started = 0;
+    for (int t = 0; t < numWorkers; t++) workers[t].run = &run;
+    for (int t = 1; t < numWorkers; t++) {
+        if (pthread_create(&threads[t], NULL, batchWorker, &workers[t]) != 0) break;
+        started = t;
+    }
+    batchWorker(&workers[0]);
+    for (int t = 1; t <= started; t++) pthread_join(threads[t], NULL);
+    pthread_rwlock_unlock(&graph->lock);
+
+    pthread_mutex_destroy(&run.lock);
+    for (int t = 0; t < numWorkers; t++) {
+        freeSearchState(workers[t].forward);
+        freeSearchState(workers[t].backward);
+        memRelease(&graph->memory, MEM_SEARCH, workerBytes);
+    }
+    for (int i = 0; i < numQueries; i++) {
+        free(queries[i].source);
+        free(queries[i].target);
+    }
+    free(queries);
+    free(workers);
+    return numQueries;
+}
+
+// Writes the neighbours of vertex over nonzero edges into out, which has
+// room for every vertex, in increasing id order. Returns how many.
+static int listNeighbours(Graph* graph, SearchState* state, int vertex, int forward, int* out) {
+    int count = 0;
+    if (graph->disk) {
+        DiskEdge* edges = diskBuffer(graph->disk, state);
+        int degree = edges ? diskGraphNeighbours(graph->disk, vertex, forward, edges) : -1;
+        for (int j = 0; j < degree; j++) {
+            if (edges[j].weight) out[count++] = edges[j].dest;
+        }
+        return count;
+    }
+    if (graph->outAdj) {
+        const CompressedAdjacency* adj = forward ? graph->outAdj : graph->inAdj;
+        int* dests = decodeBuffer(adj, state);
+        if (!dests) return 0;
+        int* weights = dests + state->decodedCapacity;
+        int degree = adjDecode(adj, vertex, dests, weights);
+        for (int j = 0; j < degree; j++) {
+            if (weights[j]) out[count++] = dests[j];
+        }
+        return count;
+    }
+    for (int i = 0; i < graph->numVertices; i++) {
+        if (forward ? graph->adjMatrix[vertex][i] : graph->adjMatrix[i][vertex]) out[count++] = i;
+    }
+    return count;
+}
+
+// BFS from whatever the state was seeded with, expanding nothing at
+// maxDepth or beyond and stopping once the level of stopAt is reached
+static void boundedBfs(Graph* graph, SearchState* state, int forward, int maxDepth, int stopAt) {
+    while (state->front < state->rear) {
+        int u = state->queue[state->front++];
+        if (isVisited(state, stopAt) && state->distance[u] >= state->distance[stopAt]) break;
+        if (state->distance[u] < maxDepth) bfsStep(graph, state, u, forward);
+    }
+}
+
+static int onShortestPath(const SearchState* forward, const SearchState* backward,
+                          int v, int hops) {
+    return isVisited(forward, v) && isVisited(backward, v) &&
+           forward->distance[v] + backward->distance[v] == hops;
+}
+
+// Counts the shortest paths from source to target without listing them.
+// A BFS from each end gives every vertex its distance from the source and
+// to the target; the edges u -> w with df[u] + 1 + db[w] equal to the
+// distance form the shortest-path DAG, whose paths are summed level by
+// level in forward BFS order, so the forward search runs to the full
+// distance. It stops at maxHops (0 = no cap), longer paths are not
+// counted, and the backward search stops at the distance found. Returns
+// -1 on errors.
+int countShortestPaths(Graph* graph, const char* source_url, const char* target_url,
+                       int maxHops, PathCount* result) {
+    memset(result, 0, sizeof(PathCount));
+    result->hops = -1;
+
+    pthread_rwlock_rdlock(&graph->lock);
+    int source = findVertexByUrl(graph, source_url);
+    int target = findVertexByUrl(graph, target_url);
+    if (source == -1 || target == -1) {
+        pthread_rwlock_unlock(&graph->lock);
+        printf("Error: Source or target URL not found in graph\n");
+        return -1;
+    }
+
+    int n = graph->numVertices;
+    size_t searchBytes = 2 * (sizeof(SearchState) + 4 * (size_t)n * sizeof(int)) +
+                         (size_t)n * (sizeof(unsigned long long) + sizeof(int));
+    if (!memReserve(&graph->memory, MEM_SEARCH, searchBytes)) {
+        pthread_rwlock_unlock(&graph->lock);
+        printf("Error: Search state would exceed the memory budget\n");
+        return -1;
+    }
+    SearchState* forward = createSearchState(n);
+    SearchState* backward = createSearchState(n);
+    unsigned long long* count = (unsigned long long*)calloc(n, sizeof(unsigned long long));
+    int* neighbours = (int*)malloc(n * sizeof(int));
+    int ok = count && neighbours;
+
+    if (ok) {
+        seedSearch(forward, source);
+        boundedBfs(graph, forward, 1, maxHops > 0 ? maxHops : INT_MAX, target);
+    }
+    if (ok && isVisited(forward, target)) {
+        int hops = forward->distance[target];
+        seedSearch(backward, target);
+        boundedBfs(graph, backward, 0, hops, source);
+        result->hops = hops;
+
+        count[source] = 1;
+        for (int q = 0; q < forward->rear; q++) {
+            int u = forward->queue[q];
+            if (!onShortestPath(forward, backward, u, hops)) continue;
+            result->dagVertices++;
+            if (u == target) continue;
+            int degree = listNeighbours(graph, forward, u, 1, neighbours);
+            for (int j = 0; j < degree; j++) {
+                int w = neighbours[j];
+                if (forward->distance[w] != forward->distance[u] + 1 ||
+                    !onShortestPath(forward, backward, w, hops)) continue;
+                result->dagEdges++;
+                if (count[w] > ULLONG_MAX - count[u]) {
+                    count[w] = ULLONG_MAX;
+                    result->saturated = 1;
+                } else {
+                    count[w] += count[u];
+                }
+            }
+        }
+        result->count = count[target];
+    }
+    pthread_rwlock_unlock(&graph->lock);
+
+    freeSearchState(forward);
+    freeSearchState(backward);
+    free(count);
+    free(neighbours);
+    memRelease(&graph->memory, MEM_SEARCH, searchBytes);
+    if (!ok) printf("Error: Not enough memory to count paths\n");
+    return ok ? 0 : -1;
+}
+
+// Enumerates loopless source -> target paths in order of length with
+// Yen's algorithm, one per call, each within maxHops (0 = no cap).
+// Returns NULL for unknown URLs or when out of memory.
+PathEnumerator* startPathEnumeration(Graph* graph, const char* source_url,
+                                     const char* target_url, int maxHops) {
+    int source = findVertexByUrl(graph, source_url);
+    int target = findVertexByUrl(graph, target_url);
+    if (source == -1 || target == -1) {
+        printf("Error: Source or target URL not found in graph\n");
+        return NULL;
+    }
+
+    size_t searchBytes = 2 * (sizeof(SearchState) + 4 * (size_t)graph->numVertices * sizeof(int)) +
+                         (size_t)graph->numVertices * sizeof(int);
+    if (!memReserve(&graph->memory, MEM_SEARCH, searchBytes)) {
+        printf("Error: Search state would exceed the memory budget\n");
+        return NULL;
+    }
+    PathEnumerator* paths = (PathEnumerator*)calloc(1, sizeof(PathEnumerator));
+    int* neighbours = (int*)malloc(graph->numVertices * sizeof(int));
+    if (!paths || !neighbours) {
+        printf("Error: Not enough memory to enumerate paths\n");
+        free(paths);
+        free(neighbours);
+        memRelease(&graph->memory, MEM_SEARCH, searchBytes);
+        return NULL;
+    }
+    paths->graph = graph;
+    paths->source = source;
+    paths->target = target;
+    paths->maxHops = maxHops;
+    paths->version = graph->version;
+    paths->forward = createSearchState(graph->numVertices);
+    paths->backward = createSearchState(graph->numVertices);
+    paths->neighbours = neighbours;
+    paths->searchBytes = searchBytes;
+    return paths;
+}
+
+static int samePath(const Path* a, const Path* b) {
+    return a->length == b->length &&
+           memcmp(a->path, b->path, a->length * sizeof(int)) == 0;
+}
+
+static int appendPath(Path*** list, int* count, int* capacity, Path* path) {
+    if (*count == *capacity) {
+        int grown = *capacity ? *capacity * 2 : 8;
+        Path** bigger = (Path**)realloc(*list, grown * sizeof(Path*));
+        if (!bigger) return 0;
+        *list = bigger;
+        *capacity = grown;
+    }
+    (*list)[(*count)++] = path;
+    return 1;
+}
+
+// Keeps a spur candidate unless it is already known
+static void addCandidate(PathEnumerator* paths, Path* path) {
+    for (int i = 0; i < paths->numFound; i++) {
+        if (samePath(paths->found[i], path)) {
+            freePath(path);
+            return;
+        }
+    }
+    for (int i = 0; i < paths->numCandidates; i++) {
+        if (samePath(paths->candidates[i], path)) {
+            freePath(path);
+            return;
+        }
+    }
+    if (!appendPath(&paths->candidates, &paths->numCandidates, &paths->candidateCapacity, path)) {
+        freePath(path);
+    }
+}
+
+// An edge spur -> w may not be taken if a path already found shares the
+// root up to the spur and continues with it
+static int spurEdgeUsed(const PathEnumerator* paths, const Path* last, int spurIndex, int w) {
+    for (int k = 0; k < paths->numFound; k++) {
+        const Path* p = paths->found[k];
+        if (p->length > spurIndex + 1 && p->path[spurIndex + 1] == w &&
+            memcmp(p->path, last->path, (spurIndex + 1) * sizeof(int)) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Yen's spur step: for every vertex of the last path, search from it to
+// the target while avoiding the root before it and the edges other found
+// paths already took from it. The bidirectional search does the work. The
+// root's vertices are marked visited in both states and the spur's
+// allowed neighbours seed the forward side, so nothing in the search
+// itself has to know about removed edges.
+static void addSpurCandidates(PathEnumerator* paths, const Path* last) {
+    Graph* graph = paths->graph;
+    SearchState* forward = paths->forward;
+    SearchState* backward = paths->backward;
+
+    for (int i = 0; i < last->length - 1; i++) {
+        int remaining = paths->maxHops > 0 ? paths->maxHops - i : 0;
+        if (paths->maxHops > 0 && remaining < 1) break;
+        int spur = last->path[i];
+
+        resetSearchState(forward);
+        resetSearchState(backward);
+        for (int j = 0; j <= i; j++) {
+            forward->visited[last->path[j]] = forward->epoch;
+            backward->visited[last->path[j]] = backward->epoch;
+        }
+        forward->parent[spur] = -1;
+        forward->distance[spur] = 0;
+        seedSearch(backward, paths->target);
+
+        int degree = listNeighbours(graph, forward, spur, 1, paths->neighbours);
+        for (int j = 0; j < degree; j++) {
+            int w = paths->neighbours[j];
+            if (isVisited(forward, w) || spurEdgeUsed(paths, last, i, w)) continue;
+            forward->queue[forward->rear++] = w;
+            forward->visited[w] = forward->epoch;
+            forward->parent[w] = spur;
+            forward->distance[w] = 1;
+        }
+
+        int iterations;
+        int intersection = searchFromSeeds(graph, forward, backward, 0, &iterations,
+                                           remaining, NULL);
+        if (intersection == -1) continue;
+
+        Path* spurPath = reconstructPath(forward, backward, spur, paths->target, intersection);
+        Path* candidate = (Path*)malloc(sizeof(Path));
+        int* vertices = (int*)malloc((i + spurPath->length) * sizeof(int));
+        if (!candidate || !vertices) {
+            free(candidate);
+            free(vertices);
+            freePath(spurPath);
+            continue;
+        }
+        memcpy(vertices, last->path, i * sizeof(int));
+        memcpy(vertices + i, spurPath->path, spurPath->length * sizeof(int));
+        candidate->path = vertices;
+        candidate->length = i + spurPath->length;
+        freePath(spurPath);
+        addCandidate(paths, candidate);
+    }
+}
+
+// Returns the next shortest loopless path, or NULL once there are no more
+// within the hop cap. The path belongs to the enumerator. Only the spur
+// searches off the previous path are run, so asking for k paths costs k
+// rounds. Stops if the graph changes between calls.
+const Path* nextShortestPath(PathEnumerator* paths) {
+    Graph* graph = paths->graph;
+    if (paths->exhausted) return NULL;
+
+    pthread_rwlock_rdlock(&graph->lock);
+    Path* next = NULL;
+    if (graph->version != paths->version) {
+        printf("Error: The graph changed while its paths were being enumerated\n");
+    } else if (paths->numFound == 0) {
+        resetSearchState(paths->forward);
+        resetSearchState(paths->backward);
+        seedSearch(paths->forward, paths->source);
+        seedSearch(paths->backward, paths->target);
+        int iterations;
+        int intersection = searchFromSeeds(graph, paths->forward, paths->backward, 0,
+                                           &iterations, paths->maxHops, NULL);
+        if (intersection != -1) {
+            next = reconstructPath(paths->forward, paths->backward, paths->source,
+                                   paths->target, intersection);
+        }
+    } else {
+        addSpurCandidates(paths, paths->found[paths->numFound - 1]);
+        int best = -1;
+        for (int i = 0; i < paths->numCandidates; i++) {
+            if (best == -1 || paths->candidates[i]->length < paths->candidates[best]->length) {
+                best = i;
+            }
+        }
+        if (best != -1) {
+            next = paths->candidates[best];
+            memmove(paths->candidates + best, paths->candidates + best + 1,
+                    (paths->numCandidates - best - 1) * sizeof(Path*));
+            paths->numCandidates--;
+        }
+    }
+    pthread_rwlock_unlock(&graph->lock);
+
+    if (next && !appendPath(&paths->found, &paths->numFound, &paths->foundCapacity, next)) {
+        freePath(next);
+        next = NULL;
+    }
+    if (!next) paths->exhausted = 1;
+    return next;
+}
+
+void freePathEnumerator(PathEnumerator* paths) {
+    if (!paths) return;
+    for (int i = 0; i < paths->numFound; i++) freePath(paths->found[i]);
+    for (int i = 0; i < paths->numCandidates; i++) freePath(paths->candidates[i]);
+    free(paths->found);
+    free(paths->candidates);
+    freeSearchState(paths->forward);
+    freeSearchState(paths->backward);
+    free(paths->neighbours);
+    memRelease(&paths->graph->memory, MEM_SEARCH, paths->searchBytes);
+    free(paths);
+}
+
+
+
+void printPathDetails(Graph* graph, const Path* path) {
+    char fromBuf[MAX_URL_LENGTH], toBuf[MAX_URL_LENGTH];
     if (!path || path->length <= 1) return;
     
     printf("\n=== Path Details ===\n");
@@ -351,53 +974,60 @@ void printPathDetails(Graph* graph, Path* path) {
     for (int i = 0; i < path->length - 1; i++) {
         int from = path->path[i];
         int to = path->path[i + 1];
-        int weight = graph->adjMatrix[from][to];
+        int weight = getEdgeWeight(graph, from, to);
         total_weight += weight;
         
         printf("%d.\t%s\t->\t%s\t%d\n",
                i + 1,
-               graph->nodes[from].url,
-               graph->nodes[to].url,
+               getVertexUrl(graph, from, fromBuf),
+               getVertexUrl(graph, to, toBuf),
                weight);
     }
     
     printf("\nTotal path weight: %d\n", total_weight);
 }
 
-void writeGraphToDot(Graph* graph, const char* filename) {
-    FILE* file = fopen(filename, "w");
-    if (!file) return;
+void visualizeBidirectionalPath(Graph* graph, Path* path, const char* filename) {
+    visualizePathNeighbourhood(graph, path, -1, filename);
+}
 
-    fprintf(file, "digraph G {\n");
-    fprintf(file, "  node [shape=box];\n");
-    fprintf(file, "  rankdir=LR;\n");
-    
-    // Add all nodes first
-    for (int i = 0; i < graph->numVertices; i++) {
-        if (graph->nodes[i].url) {
-            fprintf(file, "  \"%s\" [label=\"%s\"];\n",
-                graph->nodes[i].url,
-                graph->nodes[i].url);
-        }
+// Writes the path with every vertex within hops steps of it, or the whole
+// graph when hops is negative. Each edge is emitted once, highlighted when
+// it lies on the path.
+void visualizePathNeighbourhood(Graph* graph, Path* path, int hops, const char* filename) {
+    if (graph->disk) {
+        printf("Error: DOT export needs the graph in memory, not on disk\n");
+        return;
+    }
+    char fromBuf[MAX_URL_LENGTH], toBuf[MAX_URL_LENGTH];
+    int hasPath = path && path->length > 1;
+
+    char* inSet = (char*)calloc(graph->numVertices, sizeof(char));
+    int* pathNext = (int*)malloc(graph->numVertices * sizeof(int));
+    if (!inSet || !pathNext) {
+        free(inSet);
+        free(pathNext);
+        return;
     }
-    
-    // Add all edges
     for (int i = 0; i < graph->numVertices; i++) {
-        for (int j = 0; j < graph->nodes[i].numEdges; j++) {
-            fprintf(file, "  \"%s\" -> \"%s\" [label=\"%d\"];\n",
-                graph->nodes[i].url,
-                graph->nodes[graph->nodes[i].edges[j].dest].url,
-                graph->nodes[i].edges[j].weight);
+        pathNext[i] = -1;
+        if (hops < 0) inSet[i] = 1;
+    }
+    if (hasPath) {
+        for (int i = 0; i < path->length - 1; i++) {
+            pathNext[path->path[i]] = path->path[i + 1];
         }
+        // The last vertex points at itself so it still counts as on the path
+        pathNext[path->path[path->length - 1]] = path->path[path->length - 1];
+        if (hops >= 0) collectNeighbourhood(graph, path->path, path->length, hops, inSet);
     }
-    fprintf(file, "}\n");
-    fclose(file);
-}
 
-void visualizeBidirectionalPath(Graph* graph, Path* path, const char* filename) {
-    FILE* file = fopen(filename, "w");
+    char* buffer = NULL;
+    FILE* file = openDotFile(filename, &buffer);
     if (!file) {
         perror("Error opening file");
+        free(inSet);
+        free(pathNext);
         return;
     }
 
@@ -409,33 +1039,26 @@ void visualizeBidirectionalPath(Graph* graph, Path* path, const char* filename)
     fprintf(file, "  edge [color=gray];\n");
 
     for (int i = 0; i < graph->numVertices; i++) {
-        if (graph->nodes[i].url) {
-            fprintf(file, "  \"%s\" [label=\"%s\"];\n",
-                graph->nodes[i].url,
-                graph->nodes[i].url);
+        if (!inSet[i]) continue;
+        if (hasVertexUrl(graph, i)) {
+            const char* url = getVertexUrl(graph, i, fromBuf);
+            fprintf(file, "  \"%s\" [label=\"%s\"%s];\n", url, url,
+                pathNext[i] != -1 ? ",fillcolor=lightblue" : "");
         }
         
-        for (int j = 0; j < graph->nodes[i].numEdges; j++) {
-            fprintf(file, "  \"%s\" -> \"%s\" [label=\"%d\"];\n",
-                graph->nodes[i].url,
-                graph->nodes[graph->nodes[i].edges[j].dest].url,
-                graph->nodes[i].edges[j].weight);
+        EdgeCursor cursor;
+        int dest, weight;
+        outEdgesBegin(graph, i, &cursor);
+        while (outEdgesNext(&cursor, &dest, &weight)) {
+            if (!inSet[dest]) continue;
+            fprintf(file, "  \"%s\" -> \"%s\" [label=\"%d\"%s];\n",
+                getVertexUrl(graph, i, fromBuf),
+                getVertexUrl(graph, dest, toBuf),
+                weight,
+                (pathNext[i] == dest && dest != i) ? ",color=blue,penwidth=2.0" : "");
         }
     }
-    if (path && path->length > 1) {
-        for (int i = 0; i < path->length; i++) {
-            fprintf(file, "  \"%s\" [fillcolor=lightblue];\n",
-                graph->nodes[path->path[i]].url);
-        }
-
-        for (int i = 0; i < path->length - 1; i++) {
-            int from = path->path[i];
-            int to = path->path[i + 1];
-            fprintf(file, "  \"%s\" -> \"%s\" [color=blue,penwidth=2.0];\n",
-                graph->nodes[from].url,
-                graph->nodes[to].url);
-        }
-
+    if (hasPath) {
         fprintf(file, "  subgraph cluster_legend {\n");
         fprintf(file, "    label=\"Legend\";\n");
         fprintf(file, "    style=dotted;\n");
@@ -446,7 +1069,9 @@ void visualizeBidirectionalPath(Graph* graph, Path* path, const char* filename)
     }
 
     fprintf(file, "}\n");
-    fclose(file);
+    closeDotFile(file, buffer);
+    free(inSet);
+    free(pathNext);
 }
 
 void freePath(Path* path) {
@@ -454,4 +1079,4 @@ void freePath(Path* path) {
         free(path->path);
         free(path);
     }
-}
\ No newline at end of file
+}
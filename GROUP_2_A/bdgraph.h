@@ -1,32 +1,10 @@
 #ifndef BDGRAPH_H
 #define BDGRAPH_H
 
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <limits.h>
-
-#define MAX_VERTICES 1000
-#define MAX_URL_LENGTH 256
-
-typedef struct Edge {
-    int dest;
-    int weight;
-} Edge;
-
-typedef struct Node {
-    int vertex;
-    char* url;
-    Edge* edges;
-    int numEdges;
-} Node;
-
-typedef struct Graph {
-    Node* nodes;
-    int** adjMatrix;
-    int numVertices;
-} Graph;
+#include "graph.h"
 
+// visited holds the epoch of the search that last reached each vertex, so
+// a state can be reused without clearing it
 typedef struct SearchState {
     int* visited;
     int* parent;
@@ -34,6 +12,12 @@ typedef struct SearchState {
     int* queue;
     int front;
     int rear;
+    int epoch;
+    int numVertices;
+    int readahead;          // queue position up to which lists were read ahead
+    DiskEdge* neighbours;   // one list of a disk-resident graph
+    int* decoded;           // one compressed list: dests, then weights
+    int decodedCapacity;
 } SearchState;
 
 typedef struct Path {
@@ -41,26 +25,60 @@ typedef struct Path {
     int length;
 } Path;
 
-Graph* createGraph(int vertices);
-void addEdge(Graph* graph, int src, int dest, int weight);
-int findVertexByUrl(Graph* graph, const char* url);
-void processUrlFile(Graph* graph, const char* filename);
-void freeGraph(Graph* graph);
+// Size of the shortest-path DAG between two vertices and how many paths
+// run through it
+typedef struct PathCount {
+    int hops;                   // -1 if there is no path within the cap
+    unsigned long long count;
+    int saturated;              // count overflowed and is a lower bound
+    int dagVertices;
+    int dagEdges;
+} PathCount;
+
+// Yen's k shortest loopless paths, produced one call at a time. found
+// holds the paths returned so far, candidates the spur paths not yet used.
+typedef struct PathEnumerator {
+    Graph* graph;
+    int source;
+    int target;
+    int maxHops;
+    unsigned long version;
+    Path** found;
+    int numFound;
+    int foundCapacity;
+    Path** candidates;
+    int numCandidates;
+    int candidateCapacity;
+    SearchState* forward;
+    SearchState* backward;
+    int* neighbours;
+    size_t searchBytes;
+    int exhausted;
+} PathEnumerator;
 
-void printWeightedEdgeList(Graph* graph);
-void printAdjacencyList(Graph* graph);
-void printAdjacencyMatrix(Graph* graph);
-void writeGraphToDot(Graph* graph, const char* filename);
+void enablePathCache(Graph* graph, int capacity);
 
 SearchState* createSearchState(int vertices);
+void resetSearchState(SearchState* state);
 void freeSearchState(SearchState* state);
-void bfsStep(Graph* graph, SearchState* state, int vertex, int forward);
+int bfsStep(Graph* graph, SearchState* state, int vertex, int forward);
 Path* reconstructPath(SearchState* forward, SearchState* backward, 
                      int source, int target, int intersection);
 Path* bidirectionalSearch(Graph* graph, const char* source_url, const char* target_url);
-void printPathDetails(Graph* graph, Path* path);
+Path* bidirectionalSearchWithContext(Graph* graph, const char* source_url,
+                                     const char* target_url, QueryContext* ctx);
+int batchShortestPaths(Graph* graph, const char* filename, int numThreads,
+                       const QueryContext* limits);
+int countShortestPaths(Graph* graph, const char* source_url, const char* target_url,
+                       int maxHops, PathCount* result);
+PathEnumerator* startPathEnumeration(Graph* graph, const char* source_url,
+                                     const char* target_url, int maxHops);
+const Path* nextShortestPath(PathEnumerator* paths);
+void freePathEnumerator(PathEnumerator* paths);
+void printPathDetails(Graph* graph, const Path* path);
 void visualizeBidirectionalPath(Graph* graph, Path* path, const char* filename);
+void visualizePathNeighbourhood(Graph* graph, Path* path, int hops, const char* filename);
 
 void freePath(Path* path);
 
-#endif
\ No newline at end of file
+#endif
@@ -3,18 +3,68 @@
 #include <string.h>
 #include "bdgraph.h"
 
-
+#define MAX_VERTICES 1000
 
 int main(int argc, char* argv[]) {
-    Graph* graph = createGraph(MAX_VERTICES);
     char source_url[MAX_URL_LENGTH];
     char target_url[MAX_URL_LENGTH];
     char filename[256];
+    char urlBuf[MAX_URL_LENGTH];
     
-    if (argc > 1) {
-        strncpy(filename, argv[1], sizeof(filename) - 1);
-        filename[sizeof(filename) - 1] = '\0';
-    } else {
+    VertexOrder order = ORDER_NONE;
+    DuplicatePolicy duplicates = DUPLICATE_LAST;
+    int compress = 0;
+    int cacheSize = 0;
+    int dotHops = -1;
+    const char* updatesFile = NULL;
+    const char* batchFile = NULL;
+    int numThreads = 0;
+    size_t memoryBudget = 0;
+    int haveFilename = 0;
+    QueryContext limits;
+    initQueryContext(&limits);
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--compress") == 0) {
+            compress = 1;
+        } else if (strncmp(argv[i], "--cache=", 8) == 0) {
+            cacheSize = atoi(argv[i] + 8);
+        } else if (strncmp(argv[i], "--dot-hops=", 11) == 0) {
+            dotHops = atoi(argv[i] + 11);
+        } else if (strncmp(argv[i], "--updates=", 10) == 0) {
+            updatesFile = argv[i] + 10;
+        } else if (strncmp(argv[i], "--batch=", 8) == 0) {
+            batchFile = argv[i] + 8;
+        } else if (strncmp(argv[i], "--threads=", 10) == 0) {
+            numThreads = atoi(argv[i] + 10);
+        } else if (strncmp(argv[i], "--memory-budget=", 16) == 0) {
+            memoryBudget = (size_t)atol(argv[i] + 16) << 20;
+        } else if (parseQueryLimit(argv[i], &limits)) {
+            continue;
+        } else if (strncmp(argv[i], "--reorder=", 10) == 0) {
+            if (!parseVertexOrder(argv[i] + 10, &order)) {
+                printf("Error: Unknown vertex order '%s' (use none, bfs, rcm or degree)\n",
+                       argv[i] + 10);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--duplicates=", 13) == 0) {
+            if (!parseDuplicatePolicy(argv[i] + 13, &duplicates)) {
+                printf("Error: Unknown duplicate policy '%s' (use sum, max or last)\n",
+                       argv[i] + 13);
+                return 1;
+            }
+        } else {
+            strncpy(filename, argv[i], sizeof(filename) - 1);
+            filename[sizeof(filename) - 1] = '\0';
+            haveFilename = 1;
+        }
+    }
+    
+    Graph* graph = createGraphWithBudget(MAX_VERTICES, memoryBudget);
+    if (!graph) return 1;
+    graph->duplicatePolicy = duplicates;
+    
+    if (!haveFilename) {
         printf("Enter the filename containing URLs and links: ");
         if (scanf("%255s", filename) != 1) {
             printf("Error reading filename\n");
@@ -23,8 +73,30 @@ int main(int argc, char* argv[]) {
         }
     }
     
-    processUrlFile(graph, filename);
-    printf("Finished reading file. Processed %d vertices\n", graph->numVertices);
+    // A directory or glob loads all matching shard files in parallel
+    if (isShardPattern(filename)) {
+        processUrlShards(graph, filename);
+    } else {
+        processUrlFile(graph, filename);
+    }
+    reorderGraph(graph, order);
+    compactUrls(graph);
+    if (compress) compressGraph(graph);
+    buildReachability(graph);
+    if (updatesFile) processUpdateFile(graph, updatesFile);
+    if (cacheSize > 0) enablePathCache(graph, cacheSize);
+    
+    // --timeout, --max-settled and --max-scanned bound every search
+    QueryContext* queryLimits = hasQueryLimits(&limits) ? &limits : NULL;
+    
+    // Batch mode answers every pair in the file and skips the prompts
+    if (batchFile) {
+        int answered = batchShortestPaths(graph, batchFile, numThreads, &limits);
+        if (graph->pathCache) printPathCacheStats(graph->pathCache);
+        printMemoryStats(&graph->memory);
+        freeGraph(graph);
+        return answered < 0 ? 1 : 0;
+    }
     
     printf("\n=== Adjacency List ===\n");
     printAdjacencyList(graph);
@@ -39,8 +111,8 @@ int main(int argc, char* argv[]) {
     
     printf("\n=== Available URLs in the Graph ===\n");
     for (int i = 0; i < graph->numVertices; i++) {
-        if (graph->nodes[i].url) {
-            printf("%d. %s\n", i + 1, graph->nodes[i].url);
+        if (hasVertexUrl(graph, i)) {
+            printf("%d. %s\n", i + 1, getVertexUrl(graph, i, urlBuf));
         }
     }
     
@@ -48,8 +120,8 @@ int main(int argc, char* argv[]) {
         printf("\n=== Bidirectional Search for Shortest Path ===\n");
         printf("Available URLs:\n");
         for (int i = 0; i < graph->numVertices; i++) {
-            if (graph->nodes[i].url) {
-                printf("%d. %s\n", i + 1, graph->nodes[i].url);
+            if (hasVertexUrl(graph, i)) {
+                printf("%d. %s\n", i + 1, getVertexUrl(graph, i, urlBuf));
             }
         }
         
@@ -80,7 +152,8 @@ int main(int argc, char* argv[]) {
         printf("Target: %s\n\n", target_url);
         
         //bidirectional search
-        Path* shortest_path = bidirectionalSearch(graph, source_url, target_url);
+        Path* shortest_path = bidirectionalSearchWithContext(graph, source_url, target_url,
+                                                             queryLimits);
         
         if (shortest_path != NULL) {
             printf("\n=== Shortest Path Found ===\n");
@@ -102,7 +175,12 @@ int main(int argc, char* argv[]) {
             snprintf(viz_filename, sizeof(viz_filename), "path_%.63s_to_%.63s.dot", 
                      source_part, target_part);
             
-            visualizeBidirectionalPath(graph, shortest_path, viz_filename);
+            // With --dot-hops only the path's neighbourhood is exported
+            if (dotHops >= 0) {
+                visualizePathNeighbourhood(graph, shortest_path, dotHops, viz_filename);
+            } else {
+                visualizeBidirectionalPath(graph, shortest_path, viz_filename);
+            }
             printf("\nPath visualization has been written to %s\n", viz_filename);
             
             // Calculate and display path metrics
@@ -110,7 +188,7 @@ int main(int argc, char* argv[]) {
             for (int i = 0; i < shortest_path->length - 1; i++) {
                 int from = shortest_path->path[i];
                 int to = shortest_path->path[i + 1];
-                total_weight += graph->adjMatrix[from][to];
+                total_weight += getEdgeWeight(graph, from, to);
             }
             
             printf("\nPath Statistics:\n");
@@ -122,6 +200,8 @@ int main(int argc, char* argv[]) {
             }
             
             freePath(shortest_path);
+        } else if (queryLimits && limits.status != QUERY_OK) {
+            printf("\nSearch %s before finding an answer\n", queryStatusName(limits.status));
         } else {
             printf("\nNo path found between %s and %s\n", source_url, target_url);
         }
@@ -140,8 +220,8 @@ int main(int argc, char* argv[]) {
     printf("URLs with no outgoing links:\n");
     int dead_ends = 0;
     for (int i = 0; i < graph->numVertices; i++) {
-        if (graph->nodes[i].url && graph->nodes[i].numEdges == 0) {
-            printf("- %s\n", graph->nodes[i].url);
+        if (hasVertexUrl(graph, i) && graph->nodes[i].numEdges == 0) {
+            printf("- %s\n", getVertexUrl(graph, i, urlBuf));
             dead_ends++;
         }
     }
@@ -151,8 +231,15 @@ int main(int argc, char* argv[]) {
         printf("Total dead ends: %d\n", dead_ends);
     }
     
-    writeGraphToDot(graph, "final_graph.dot");
-    printf("\nComplete graph visualization has been written to final_graph.dot\n");
+    if (graph->pathCache) printPathCacheStats(graph->pathCache);
+    printMemoryStats(&graph->memory);
+    
+    if (dotHops >= 0) {
+        printf("\nSkipping complete graph visualization (--dot-hops is set)\n");
+    } else {
+        writeGraphToDot(graph, "final_graph.dot");
+        printf("\nComplete graph visualization has been written to final_graph.dot\n");
+    }
     
     freeGraph(graph);
     return 0;
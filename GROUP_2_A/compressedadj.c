@@ -0,0 +1,148 @@
+#include "compressedadj.h"
+
+static size_t putVarint(unsigned char* out, unsigned int value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (unsigned char)value;
+    return n;
+}
+
+// Builds from CSR arrays whose per-vertex neighbours are sorted and
+// distinct, as produced by buildEdgeList. Negative weights are not stored.
+CompressedAdjacency* compressAdjacency(int numVertices, const int* offsets,
+                                       const int* dests, const int* weights) {
+    CompressedAdjacency* adj = (CompressedAdjacency*)calloc(1, sizeof(CompressedAdjacency));
+    if (!adj) return NULL;
+
+    int numEdges = offsets[numVertices];
+    int numSkips = 0;
+    for (int v = 0; v < numVertices; v++) {
+        numSkips += (offsets[v + 1] - offsets[v]) / ADJ_SKIP_INTERVAL;
+    }
+
+    adj->numVertices = numVertices;
+    adj->offsets = (size_t*)malloc((numVertices + 1) * sizeof(size_t));
+    adj->data = (unsigned char*)malloc((size_t)numVertices * 5 + (size_t)numEdges * 10 + 1);
+    adj->skipStart = (int*)malloc((numVertices + 1) * sizeof(int));
+    adj->skipPrev = (int*)malloc((numSkips + 1) * sizeof(int));
+    adj->skipOffset = (unsigned int*)malloc((numSkips + 1) * sizeof(unsigned int));
+    if (!adj->offsets || !adj->data || !adj->skipStart || !adj->skipPrev || !adj->skipOffset) {
+        freeCompressedAdjacency(adj);
+        return NULL;
+    }
+
+    size_t pos = 0;
+    int skip = 0;
+    for (int v = 0; v < numVertices; v++) {
+        int begin = offsets[v];
+        int degree = offsets[v + 1] - begin;
+        if (degree > adj->maxDegree) adj->maxDegree = degree;
+        adj->offsets[v] = pos;
+        adj->skipStart[v] = skip;
+        pos += putVarint(adj->data + pos, (unsigned int)degree);
+
+        int prev = 0;
+        for (int j = 0; j < degree; j++) {
+            // Skip entry k lets decoding resume at neighbour k * interval
+            if (j > 0 && j % ADJ_SKIP_INTERVAL == 0) {
+                adj->skipPrev[skip] = prev;
+                adj->skipOffset[skip] = (unsigned int)(pos - adj->offsets[v]);
+                skip++;
+            }
+            int weight = weights[begin + j] < 0 ? 0 : weights[begin + j];
+            pos += putVarint(adj->data + pos, (unsigned int)(dests[begin + j] - prev));
+            pos += putVarint(adj->data + pos, (unsigned int)weight);
+            prev = dests[begin + j];
+        }
+    }
+    adj->offsets[numVertices] = pos;
+    adj->skipStart[numVertices] = skip;
+    adj->dataSize = pos;
+
+    unsigned char* shrunk = (unsigned char*)realloc(adj->data, pos + 1);
+    if (shrunk) adj->data = shrunk;
+    return adj;
+}
+
+// Decodes v's whole list into caller buffers and returns the degree. Gaps
+// and weights are split in one pass, then the ids are rebuilt with a
+// separate prefix sum that the compiler can keep in registers.
+int adjDecode(const CompressedAdjacency* adj, int v, int* dests, int* weights) {
+    if (v >= adj->numVertices) return 0;
+    const unsigned char* p = adj->data + adj->offsets[v];
+    int degree = (int)adjReadVarint(&p);
+
+    for (int j = 0; j < degree; j++) {
+        // Fast path: both fields fit in one byte
+        if (p[0] < 0x80 && p[1] < 0x80) {
+            dests[j] = p[0];
+            weights[j] = p[1];
+            p += 2;
+        } else {
+            dests[j] = (int)adjReadVarint(&p);
+            weights[j] = (int)adjReadVarint(&p);
+        }
+    }
+    for (int j = 1; j < degree; j++) {
+        dests[j] += dests[j - 1];
+    }
+    return degree;
+}
+
+// Weight of u->v, or 0 when there is no such edge. The skip index narrows
+// the scan to at most ADJ_SKIP_INTERVAL neighbours.
+int adjFindWeight(const CompressedAdjacency* adj, int u, int v) {
+    if (u >= adj->numVertices) return 0;
+    const unsigned char* base = adj->data + adj->offsets[u];
+    const unsigned char* p = base;
+    int degree = (int)adjReadVarint(&p);
+    int first = adj->skipStart[u];
+    int last = adj->skipStart[u + 1] - 1;
+    int prev = 0;
+    int consumed = 0;
+
+    //last skip entry whose block can still contain v
+    int lo = first, hi = last, found = -1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (adj->skipPrev[mid] < v) {
+            found = mid;
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    if (found != -1) {
+        p = base + adj->skipOffset[found];
+        prev = adj->skipPrev[found];
+        consumed = (found - first + 1) * ADJ_SKIP_INTERVAL;
+    }
+
+    for (int j = consumed; j < degree && j < consumed + ADJ_SKIP_INTERVAL; j++) {
+        prev += (int)adjReadVarint(&p);
+        int weight = (int)adjReadVarint(&p);
+        if (prev == v) return weight;
+        if (prev > v) break;
+    }
+    return 0;
+}
+
+size_t adjBytes(const CompressedAdjacency* adj) {
+    int numSkips = adj->skipStart[adj->numVertices];
+    return sizeof(CompressedAdjacency) + adj->dataSize + 1 +
+           (adj->numVertices + 1) * (sizeof(size_t) + sizeof(int)) +
+           (numSkips + 1) * (sizeof(int) + sizeof(unsigned int));
+}
+
+void freeCompressedAdjacency(CompressedAdjacency* adj) {
+    if (!adj) return;
+    free(adj->offsets);
+    free(adj->data);
+    free(adj->skipStart);
+    free(adj->skipPrev);
+    free(adj->skipOffset);
+    free(adj);
+}
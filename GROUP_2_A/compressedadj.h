@@ -0,0 +1,77 @@
+#ifndef COMPRESSEDADJ_H
+#define COMPRESSEDADJ_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// One skip entry per this many neighbours of a vertex
+#define ADJ_SKIP_INTERVAL 16
+
+// Per-vertex neighbour lists packed as varint(degree) followed by
+// (varint gap, varint weight) pairs. Neighbours are sorted, so gaps are
+// small; the first gap is the neighbour id itself.
+typedef struct CompressedAdjacency {
+    int numVertices;
+    int maxDegree;          // longest list, to size adjDecode buffers
+    size_t* offsets;
+    unsigned char* data;
+    size_t dataSize;
+    int* skipStart;
+    int* skipPrev;
+    unsigned int* skipOffset;
+} CompressedAdjacency;
+
+typedef struct AdjIterator {
+    const unsigned char* p;
+    int remaining;
+    int dest;
+} AdjIterator;
+
+CompressedAdjacency* compressAdjacency(int numVertices, const int* offsets,
+                                       const int* dests, const int* weights);
+int adjDecode(const CompressedAdjacency* adj, int v, int* dests, int* weights);
+int adjFindWeight(const CompressedAdjacency* adj, int u, int v);
+size_t adjBytes(const CompressedAdjacency* adj);
+void freeCompressedAdjacency(CompressedAdjacency* adj);
+
+static inline unsigned int adjReadVarint(const unsigned char** p) {
+    const unsigned char* q = *p;
+    unsigned int value = *q++;
+    if (value >= 0x80) {
+        value &= 0x7f;
+        int shift = 7;
+        unsigned int byte;
+        do {
+            byte = *q++;
+            value |= (byte & 0x7f) << shift;
+            shift += 7;
+        } while (byte >= 0x80);
+    }
+    *p = q;
+    return value;
+}
+
+// Vertices past numVertices have empty lists
+static inline void adjBegin(const CompressedAdjacency* adj, int v, AdjIterator* it) {
+    it->dest = 0;
+    if (v >= adj->numVertices) {
+        it->p = adj->data;
+        it->remaining = 0;
+        return;
+    }
+    it->p = adj->data + adj->offsets[v];
+    it->remaining = (int)adjReadVarint(&it->p);
+}
+
+// Neighbours come out in increasing id order
+static inline int adjNext(AdjIterator* it, int* dest, int* weight) {
+    if (it->remaining == 0) return 0;
+    it->dest += (int)adjReadVarint(&it->p);
+    *dest = it->dest;
+    *weight = (int)adjReadVarint(&it->p);
+    it->remaining--;
+    return 1;
+}
+
+#endif
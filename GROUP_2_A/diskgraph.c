@@ -0,0 +1,593 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include "diskgraph.h"
+
+#define DISK_MAGIC "WGDISK1"
+
+// Fixed-size header at the start of the file. Records, offsets and the
+// URL dictionary follow in that order; all values are in native byte order.
+typedef struct DiskHeader {
+    char magic[8];
+    int numVertices;
+    int maxDegree;
+    long long numEdges;
+    long long outStart;
+    long long inStart;
+    long long offsetsStart;
+    long long urlsStart;
+    int numUrls;
+    int numUrlBlocks;
+    long long urlDataSize;
+} DiskHeader;
+
+// URL -> id table used while building; ids follow first appearance, as
+// in processUrlFile
+typedef struct UrlTable {
+    char** urls;
+    unsigned long long* hashes;
+    int* table;
+    int count;
+    int capacity;
+    int tableSize;
+} UrlTable;
+
+static unsigned long long hashUrl(const char* url) {
+    unsigned long long hash = 14695981039346656037ULL;
+    for (; *url; url++) {
+        hash ^= (unsigned char)*url;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static int growUrlTable(UrlTable* urls) {
+    int capacity = urls->capacity ? urls->capacity * 2 : 1024;
+    char** strings = (char**)realloc(urls->urls, capacity * sizeof(char*));
+    if (!strings) return 0;
+    urls->urls = strings;
+    unsigned long long* hashes = (unsigned long long*)realloc(urls->hashes,
+        capacity * sizeof(unsigned long long));
+    if (!hashes) return 0;
+    urls->hashes = hashes;
+    int tableSize = capacity * 2;
+    int* table = (int*)malloc(tableSize * sizeof(int));
+    if (!table) return 0;
+    urls->capacity = capacity;
+
+    for (int i = 0; i < tableSize; i++) table[i] = -1;
+    for (int e = 0; e < urls->count; e++) {
+        int slot = (int)(urls->hashes[e] & (tableSize - 1));
+        while (table[slot] != -1) slot = (slot + 1) & (tableSize - 1);
+        table[slot] = e;
+    }
+    free(urls->table);
+    urls->table = table;
+    urls->tableSize = tableSize;
+    return 1;
+}
+
+// Returns the id of url, adding it if new, or -1 if out of memory
+static int internUrl(UrlTable* urls, const char* url) {
+    unsigned long long hash = hashUrl(url);
+    if (urls->tableSize > 0) {
+        int slot = (int)(hash & (urls->tableSize - 1));
+        for (; urls->table[slot] != -1; slot = (slot + 1) & (urls->tableSize - 1)) {
+            int e = urls->table[slot];
+            if (urls->hashes[e] == hash && strcmp(urls->urls[e], url) == 0) return e;
+        }
+    }
+    if (urls->count == urls->capacity && !growUrlTable(urls)) return -1;
+    char* copy = strdup(url);
+    if (!copy) return -1;
+
+    int id = urls->count++;
+    urls->urls[id] = copy;
+    urls->hashes[id] = hash;
+    int slot = (int)(hash & (urls->tableSize - 1));
+    while (urls->table[slot] != -1) slot = (slot + 1) & (urls->tableSize - 1);
+    urls->table[slot] = id;
+    return id;
+}
+
+static void freeUrlTable(UrlTable* urls) {
+    for (int e = 0; e < urls->count; e++) free(urls->urls[e]);
+    free(urls->urls);
+    free(urls->hashes);
+    free(urls->table);
+}
+
+// Pass 1: gives every URL an id and spools the edges as (src, dest,
+// weight) triples, counting raw degrees for the partitioning
+static int spoolLinks(FILE* in, FILE* spool, UrlTable* urls, int maxUrlLength,
+                      long long** outDegree, long long** inDegree, long long* numLines) {
+    char* line = (char*)malloc(2 * maxUrlLength + 50);
+    int degreeCapacity = 0;
+    if (!line) return 0;
+
+    while (fgets(line, 2 * maxUrlLength + 50, in)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        char* fromUrl = strtok(line, ",");
+        char* toUrl = strtok(NULL, ",");
+        char* weightToken = strtok(NULL, ",");
+        if (!fromUrl || !toUrl || !weightToken) continue;
+        //long URLs are cut like processUrlFile does, so both loads agree
+        if ((int)strlen(fromUrl) >= maxUrlLength) fromUrl[maxUrlLength - 1] = '\0';
+        if ((int)strlen(toUrl) >= maxUrlLength) toUrl[maxUrlLength - 1] = '\0';
+
+        int triple[3];
+        triple[0] = internUrl(urls, fromUrl);
+        triple[1] = internUrl(urls, toUrl);
+        triple[2] = abs(atoi(weightToken));
+        if (triple[0] < 0 || triple[1] < 0) {
+            free(line);
+            return 0;
+        }
+        if (urls->count > degreeCapacity) {
+            int capacity = urls->capacity;
+            long long* out = (long long*)realloc(*outDegree, capacity * sizeof(long long));
+            if (out) *outDegree = out;
+            long long* inward = (long long*)realloc(*inDegree, capacity * sizeof(long long));
+            if (inward) *inDegree = inward;
+            if (!out || !inward) {
+                free(line);
+                return 0;
+            }
+            memset(*outDegree + degreeCapacity, 0, (capacity - degreeCapacity) * sizeof(long long));
+            memset(*inDegree + degreeCapacity, 0, (capacity - degreeCapacity) * sizeof(long long));
+            degreeCapacity = capacity;
+        }
+        (*outDegree)[triple[0]]++;
+        (*inDegree)[triple[1]]++;
+        if (fwrite(triple, sizeof(int), 3, spool) != 3) {
+            free(line);
+            return 0;
+        }
+        (*numLines)++;
+    }
+    free(line);
+    return !ferror(in);
+}
+
+// Pass 2, once per direction: the vertex range is cut into partitions
+// whose raw edges fit the budget; each partition is pulled from the spool,
+// sorted and merged by buildEdgeList and appended to out. offsets receives
+// the first record of every vertex. Returns the records written or -1.
+static long long writeDirection(FILE* spool, FILE* out, int numVertices, int forward,
+                                const long long* degree, long long edgesPerPartition,
+                                DuplicatePolicy policy, long long* offsets, int* maxDegree) {
+    long long written = 0;
+    int lo = 0;
+    while (lo < numVertices) {
+        long long edges = degree[lo];
+        int hi = lo + 1;
+        while (hi < numVertices && edges + degree[hi] <= edgesPerPartition) edges += degree[hi++];
+
+        EdgeBuilder* builder = createEdgeBuilder(edges > 0 ? (int)edges : 1);
+        if (!builder) return -1;
+        int triple[3];
+        rewind(spool);
+        while (fread(triple, sizeof(int), 3, spool) == 3) {
+            int key = forward ? triple[0] : triple[1];
+            int other = forward ? triple[1] : triple[0];
+            if (key >= lo && key < hi && !edgeBuilderAdd(builder, key - lo, other, triple[2])) {
+                freeEdgeBuilder(builder);
+                return -1;
+            }
+        }
+        EdgeList* list = buildEdgeList(builder, numVertices, policy, 0);
+        freeEdgeBuilder(builder);
+        if (!list) return -1;
+
+        for (int v = lo; v < hi; v++) {
+            offsets[v] = written;
+            int first = list->outOffsets[v - lo], last = list->outOffsets[v - lo + 1];
+            if (last - first > *maxDegree) *maxDegree = last - first;
+            for (int a = first; a < last; a++) {
+                DiskEdge record = {list->outDest[a], list->outWeight[a]};
+                if (fwrite(&record, sizeof(DiskEdge), 1, out) != 1) {
+                    freeEdgeList(list);
+                    return -1;
+                }
+            }
+            written += last - first;
+        }
+        freeEdgeList(list);
+        lo = hi;
+    }
+    offsets[numVertices] = written;
+    return written;
+}
+
+static int writeUrlDict(FILE* out, UrlTable* urls, DiskHeader* header) {
+    int* rankOf = (int*)malloc((urls->count + 1) * sizeof(int));
+    int* rankVertex = (int*)malloc((urls->count + 1) * sizeof(int));
+    UrlDict* dict = rankOf && rankVertex ?
+        buildUrlDict((const char**)urls->urls, urls->count, rankOf) : NULL;
+    int ok = dict != NULL;
+    if (ok) {
+        for (int v = 0; v < urls->count; v++) rankVertex[rankOf[v]] = v;
+        header->numUrls = dict->numUrls;
+        header->numUrlBlocks = dict->numBlocks;
+        header->urlDataSize = (long long)dict->dataSize;
+        ok = fwrite(dict->blockOffsets, sizeof(size_t), dict->numBlocks + 1, out) ==
+                 (size_t)dict->numBlocks + 1 &&
+             fwrite(dict->data, 1, dict->dataSize, out) == dict->dataSize &&
+             fwrite(rankVertex, sizeof(int), urls->count, out) == (size_t)urls->count;
+    }
+    freeUrlDict(dict);
+    free(rankOf);
+    free(rankVertex);
+    return ok;
+}
+
+// Converts a links file ("from,to,weight" lines) into an adjacency file
+// without holding its edges in memory: they are spooled to a temporary
+// file and sorted one vertex range at a time, each range sized to fit
+// memoryBudget (0 = one range). URLs are kept in memory throughout.
+// Returns the number of edges written, or -1.
+long long buildDiskGraph(const char* linksFile, const char* diskFile, int maxUrlLength,
+                         DuplicatePolicy policy, size_t memoryBudget) {
+    FILE* in = fopen(linksFile, "r");
+    if (!in) {
+        printf("Error: Cannot open file '%s'\n", linksFile);
+        return -1;
+    }
+    FILE* spool = tmpfile();
+    FILE* out = fopen(diskFile, "wb");
+    if (!spool || !out) {
+        printf("Error: Cannot create '%s' or its temporary edge file\n", diskFile);
+        fclose(in);
+        if (spool) fclose(spool);
+        if (out) fclose(out);
+        return -1;
+    }
+
+    UrlTable urls = {0};
+    long long* outDegree = NULL;
+    long long* inDegree = NULL;
+    long long* outOffsets = NULL;
+    long long* inOffsets = NULL;
+    long long numLines = 0, outEdges = -1, inEdges = -1;
+    DiskHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DISK_MAGIC, sizeof(DISK_MAGIC));
+
+    printf("Spooling links from '%s'...\n", linksFile);
+    int ok = spoolLinks(in, spool, &urls, maxUrlLength, &outDegree, &inDegree, &numLines) &&
+             fflush(spool) == 0;
+    fclose(in);
+    int n = urls.count;
+    header.numVertices = n;
+
+    long long edgesPerPartition = memoryBudget ? (long long)(memoryBudget / DISK_BUILD_EDGE_BYTES)
+                                               : numLines;
+    if (edgesPerPartition < 1) edgesPerPartition = 1;
+    if (ok) {
+        outOffsets = (long long*)malloc((n + 1) * sizeof(long long));
+        inOffsets = (long long*)malloc((n + 1) * sizeof(long long));
+        ok = outOffsets && inOffsets && fwrite(&header, sizeof(header), 1, out) == 1;
+    }
+    if (ok) {
+        header.outStart = sizeof(header);
+        outEdges = writeDirection(spool, out, n, 1, outDegree, edgesPerPartition,
+                                  policy, outOffsets, &header.maxDegree);
+        header.inStart = header.outStart + (outEdges > 0 ? outEdges : 0) * (long long)sizeof(DiskEdge);
+        inEdges = outEdges < 0 ? -1 :
+                  writeDirection(spool, out, n, 0, inDegree, edgesPerPartition,
+                                 policy, inOffsets, &header.maxDegree);
+        ok = outEdges >= 0 && inEdges == outEdges;
+    }
+    if (ok) {
+        header.numEdges = outEdges;
+        header.offsetsStart = header.inStart + inEdges * (long long)sizeof(DiskEdge);
+        header.urlsStart = header.offsetsStart + 2 * (long long)(n + 1) * sizeof(long long);
+        ok = fwrite(outOffsets, sizeof(long long), n + 1, out) == (size_t)n + 1 &&
+             fwrite(inOffsets, sizeof(long long), n + 1, out) == (size_t)n + 1 &&
+             writeUrlDict(out, &urls, &header);
+    }
+    if (ok) {
+        rewind(out);
+        ok = fwrite(&header, sizeof(header), 1, out) == 1;
+    }
+    if (fclose(out) != 0) ok = 0;
+    fclose(spool);
+
+    if (ok) {
+        printf("Wrote '%s': %d vertices, %lld edges from %lld lines (%lld merged)\n",
+               diskFile, n, outEdges, numLines, numLines - outEdges);
+    } else {
+        printf("Error: Could not write the adjacency file '%s'\n", diskFile);
+        remove(diskFile);
+    }
+    freeUrlTable(&urls);
+    free(outDegree);
+    free(inDegree);
+    free(outOffsets);
+    free(inOffsets);
+    return ok ? outEdges : -1;
+}
+
+static int readAt(int fd, void* buffer, size_t bytes, long long position) {
+    size_t done = 0;
+    while (done < bytes) {
+        ssize_t got = pread(fd, (char*)buffer + done, bytes - done, position + (long long)done);
+        if (got <= 0) return 0;
+        done += (size_t)got;
+    }
+    return 1;
+}
+
+// Loads the vertex index and URLs of an adjacency file written by
+// buildDiskGraph and sets up a cache of cacheBytes (0 = default). The
+// cache never holds more blocks than the file has, and with a budget it
+// gets at most half of what the index leaves, the rest being kept for
+// search state. Fails only if the index alone is over the budget.
+DiskGraph* openDiskGraph(const char* filename, size_t cacheBytes, size_t budget) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        printf("Error: Cannot open file '%s'\n", filename);
+        return NULL;
+    }
+    DiskHeader header;
+    if (!readAt(fd, &header, sizeof(header), 0) ||
+        memcmp(header.magic, DISK_MAGIC, sizeof(DISK_MAGIC)) != 0) {
+        printf("Error: '%s' is not an adjacency file\n", filename);
+        close(fd);
+        return NULL;
+    }
+
+    DiskGraph* disk = (DiskGraph*)calloc(1, sizeof(DiskGraph));
+    if (!disk) {
+        close(fd);
+        return NULL;
+    }
+    pthread_mutex_init(&disk->lock, NULL);
+    disk->fd = fd;
+    disk->numVertices = header.numVertices;
+    disk->maxDegree = header.maxDegree;
+    disk->numEdges = header.numEdges;
+    disk->outStart = header.outStart;
+    disk->inStart = header.inStart;
+
+    int n = header.numVertices;
+    size_t offsetBytes = (size_t)(n + 1) * sizeof(long long);
+    disk->outOffsets = (long long*)malloc(offsetBytes);
+    disk->inOffsets = (long long*)malloc(offsetBytes);
+    disk->urlRank = (int*)malloc((n + 1) * sizeof(int));
+    disk->rankVertex = (int*)malloc((header.numUrls + 1) * sizeof(int));
+    disk->urlDict = (UrlDict*)calloc(1, sizeof(UrlDict));
+    if (disk->urlDict) {
+        disk->urlDict->numUrls = header.numUrls;
+        disk->urlDict->numBlocks = header.numUrlBlocks;
+        disk->urlDict->dataSize = (size_t)header.urlDataSize;
+        disk->urlDict->blockOffsets = (size_t*)malloc((header.numUrlBlocks + 1) * sizeof(size_t));
+        disk->urlDict->data = (unsigned char*)malloc(header.urlDataSize + 1);
+    }
+    long long position = header.offsetsStart;
+    int ok = disk->outOffsets && disk->inOffsets && disk->urlRank && disk->rankVertex &&
+             disk->urlDict && disk->urlDict->blockOffsets && disk->urlDict->data;
+    if (ok) {
+        size_t blockBytes = (header.numUrlBlocks + 1) * sizeof(size_t);
+        ok = readAt(fd, disk->outOffsets, offsetBytes, position) &&
+             readAt(fd, disk->inOffsets, offsetBytes, position + offsetBytes) &&
+             readAt(fd, disk->urlDict->blockOffsets, blockBytes, header.urlsStart) &&
+             readAt(fd, disk->urlDict->data, header.urlDataSize, header.urlsStart + blockBytes) &&
+             readAt(fd, disk->rankVertex, header.numUrls * sizeof(int),
+                    header.urlsStart + blockBytes + header.urlDataSize);
+    }
+
+    size_t indexBytes = diskGraphBytes(disk);
+    if (ok && budget && indexBytes > budget) {
+        printf("Error: The index of '%s' needs %zu bytes, over the memory budget\n",
+               filename, indexBytes);
+        closeDiskGraph(disk);
+        return NULL;
+    }
+    if (!cacheBytes) cacheBytes = DISK_CACHE_DEFAULT_BYTES;
+    long long blocks = (long long)(cacheBytes / DISK_BLOCK_SIZE);
+    if (blocks < 4) blocks = 4;
+    long long fileBlocks = (header.offsetsStart - 1) / DISK_BLOCK_SIZE + 1;
+    if (blocks > fileBlocks) blocks = fileBlocks;
+    if (budget) {
+        //a slot plus up to four hash buckets
+        size_t slotBytes = DISK_BLOCK_SIZE + sizeof(long long) + 1 + 5 * sizeof(int);
+        long long fit = (long long)((budget - indexBytes) / 2 / slotBytes);
+        if (blocks > fit) blocks = fit > 1 ? fit : 1;
+    }
+    disk->numBlocks = (int)blocks;
+    disk->numBuckets = 1;
+    while (disk->numBuckets < 2 * disk->numBlocks) disk->numBuckets *= 2;
+    if (ok) {
+        disk->blocks = (unsigned char*)malloc((size_t)disk->numBlocks * DISK_BLOCK_SIZE);
+        disk->blockTag = (long long*)malloc(disk->numBlocks * sizeof(long long));
+        disk->referenced = (char*)calloc(disk->numBlocks, sizeof(char));
+        disk->chain = (int*)malloc(disk->numBlocks * sizeof(int));
+        disk->bucket = (int*)malloc(disk->numBuckets * sizeof(int));
+        ok = disk->blocks && disk->blockTag && disk->referenced && disk->chain && disk->bucket;
+    }
+    if (!ok) {
+        printf("Error: Could not load the index of '%s'\n", filename);
+        closeDiskGraph(disk);
+        return NULL;
+    }
+    for (int s = 0; s < disk->numBlocks; s++) disk->blockTag[s] = -1;
+    for (int b = 0; b < disk->numBuckets; b++) disk->bucket[b] = -1;
+    for (int v = 0; v < n; v++) disk->urlRank[v] = -1;
+    for (int r = 0; r < header.numUrls; r++) disk->urlRank[disk->rankVertex[r]] = r;
+    return disk;
+}
+
+static int blockBucket(const DiskGraph* disk, long long block) {
+    return (int)(((unsigned long long)block * 0x9E3779B97F4A7C15ULL >> 20) &
+                 (disk->numBuckets - 1));
+}
+
+static int findBlock(const DiskGraph* disk, long long block) {
+    for (int s = disk->bucket[blockBucket(disk, block)]; s != -1; s = disk->chain[s]) {
+        if (disk->blockTag[s] == block) return s;
+    }
+    return -1;
+}
+
+// CLOCK: sweep past recently used slots, clearing their bit, and evict
+// the first one that was not used since the last sweep
+static int evictSlot(DiskGraph* disk) {
+    while (disk->referenced[disk->hand]) {
+        disk->referenced[disk->hand] = 0;
+        disk->hand = (disk->hand + 1) % disk->numBlocks;
+    }
+    int s = disk->hand;
+    disk->hand = (disk->hand + 1) % disk->numBlocks;
+
+    if (disk->blockTag[s] != -1) {
+        int* link = &disk->bucket[blockBucket(disk, disk->blockTag[s])];
+        while (*link != s) link = &disk->chain[*link];
+        *link = disk->chain[s];
+    }
+    return s;
+}
+
+// Copies count records starting at file position start into edges. Blocks
+// are read without the lock held; if two threads miss on the same block
+// the second simply finds the first one's copy.
+static int copyRecords(DiskGraph* disk, long long start, long long count, DiskEdge* edges) {
+    long long position = start, end = start + count * (long long)sizeof(DiskEdge);
+    unsigned char* scratch = NULL;
+
+    while (position < end) {
+        long long block = position / DISK_BLOCK_SIZE;
+        long long within = position % DISK_BLOCK_SIZE;
+        long long take = DISK_BLOCK_SIZE - within;
+        if (take > end - position) take = end - position;
+
+        pthread_mutex_lock(&disk->lock);
+        int s = findBlock(disk, block);
+        if (s == -1) {
+            pthread_mutex_unlock(&disk->lock);
+            if (!scratch) scratch = (unsigned char*)malloc(DISK_BLOCK_SIZE);
+            ssize_t got = scratch ? pread(disk->fd, scratch, DISK_BLOCK_SIZE,
+                                          block * DISK_BLOCK_SIZE) : -1;
+            if (got < within + take) {
+                free(scratch);
+                return 0;
+            }
+            pthread_mutex_lock(&disk->lock);
+            s = findBlock(disk, block);
+            if (s == -1) {
+                s = evictSlot(disk);
+                memcpy(disk->blocks + (size_t)s * DISK_BLOCK_SIZE, scratch, got);
+                disk->blockTag[s] = block;
+                int b = blockBucket(disk, block);
+                disk->chain[s] = disk->bucket[b];
+                disk->bucket[b] = s;
+            }
+            disk->misses++;
+        } else {
+            disk->hits++;
+        }
+        disk->referenced[s] = 1;
+        memcpy((unsigned char*)edges + (position - start),
+               disk->blocks + (size_t)s * DISK_BLOCK_SIZE + within, take);
+        pthread_mutex_unlock(&disk->lock);
+        position += take;
+    }
+    free(scratch);
+    return 1;
+}
+
+// Fills edges (room for maxDegree records) with the out- or in-list of v,
+// sorted by neighbour id. Returns its length, or -1 on a read error.
+int diskGraphNeighbours(DiskGraph* disk, int v, int forward, DiskEdge* edges) {
+    if (v < 0 || v >= disk->numVertices) return 0;
+    const long long* offsets = forward ? disk->outOffsets : disk->inOffsets;
+    long long base = forward ? disk->outStart : disk->inStart;
+    long long count = offsets[v + 1] - offsets[v];
+    if (count == 0) return 0;
+    if (!copyRecords(disk, base + offsets[v] * (long long)sizeof(DiskEdge), count, edges)) {
+        return -1;
+    }
+    return (int)count;
+}
+
+// Binary search over the records of u's out-list, one record at a time,
+// so only the blocks on the search path are touched. Returns 0 if absent.
+int diskGraphFindWeight(DiskGraph* disk, int u, int v) {
+    if (u < 0 || u >= disk->numVertices) return 0;
+    long long lo = disk->outOffsets[u], hi = disk->outOffsets[u + 1] - 1;
+    while (lo <= hi) {
+        long long mid = lo + (hi - lo) / 2;
+        DiskEdge record;
+        if (!copyRecords(disk, disk->outStart + mid * (long long)sizeof(DiskEdge), 1, &record)) {
+            return 0;
+        }
+        if (record.dest == v) return record.weight;
+        if (record.dest < v) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return 0;
+}
+
+// Asks the kernel to start reading the lists of the given frontier
+// vertices, so they are in the page cache by the time the search
+// dequeues them. Lists whose blocks are already cached are skipped.
+void diskGraphReadahead(DiskGraph* disk, const int* vertices, int count, int forward) {
+    const long long* offsets = forward ? disk->outOffsets : disk->inOffsets;
+    long long base = forward ? disk->outStart : disk->inStart;
+    for (int i = 0; i < count; i++) {
+        int v = vertices[i];
+        long long records = offsets[v + 1] - offsets[v];
+        if (records == 0) continue;
+        long long start = base + offsets[v] * (long long)sizeof(DiskEdge);
+        long long bytes = records * (long long)sizeof(DiskEdge);
+
+        pthread_mutex_lock(&disk->lock);
+        int cached = findBlock(disk, start / DISK_BLOCK_SIZE) != -1 &&
+                     findBlock(disk, (start + bytes - 1) / DISK_BLOCK_SIZE) != -1;
+        if (!cached) disk->readaheads++;
+        pthread_mutex_unlock(&disk->lock);
+        if (!cached) posix_fadvise(disk->fd, start, bytes, POSIX_FADV_WILLNEED);
+    }
+}
+
+// Memory held for the index, URLs and block cache
+size_t diskGraphBytes(const DiskGraph* disk) {
+    size_t bytes = sizeof(DiskGraph) +
+                   2 * (size_t)(disk->numVertices + 1) * sizeof(long long) +
+                   (size_t)disk->numBlocks * (DISK_BLOCK_SIZE + sizeof(long long) + 1 + sizeof(int)) +
+                   (size_t)disk->numBuckets * sizeof(int);
+    if (disk->urlDict) {
+        bytes += urlDictBytes(disk->urlDict) +
+                 (size_t)(disk->numVertices + disk->urlDict->numUrls) * sizeof(int);
+    }
+    return bytes;
+}
+
+void printDiskCacheStats(DiskGraph* disk) {
+    pthread_mutex_lock(&disk->lock);
+    long reads = disk->hits + disk->misses;
+    printf("\n=== Disk Block Cache ===\n");
+    printf("Blocks: %d x %d KiB\n", disk->numBlocks, DISK_BLOCK_SIZE >> 10);
+    printf("Block reads: %ld (hits: %ld, misses: %ld)\n", reads, disk->hits, disk->misses);
+    printf("Readahead hints: %ld\n", disk->readaheads);
+    if (reads > 0) {
+        printf("Hit rate: %.1f%%\n", 100.0 * disk->hits / reads);
+    }
+    pthread_mutex_unlock(&disk->lock);
+}
+
+void closeDiskGraph(DiskGraph* disk) {
+    if (!disk) return;
+    close(disk->fd);
+    free(disk->outOffsets);
+    free(disk->inOffsets);
+    freeUrlDict(disk->urlDict);
+    free(disk->urlRank);
+    free(disk->rankVertex);
+    free(disk->blocks);
+    free(disk->blockTag);
+    free(disk->referenced);
+    free(disk->chain);
+    free(disk->bucket);
+    pthread_mutex_destroy(&disk->lock);
+    free(disk);
+}
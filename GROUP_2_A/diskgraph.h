@@ -0,0 +1,70 @@
+#ifndef DISKGRAPH_H
+#define DISKGRAPH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "edgebuilder.h"
+#include "urldict.h"
+
+// Size of one cached piece of the adjacency file
+#define DISK_BLOCK_SIZE (64 << 10)
+
+// Cache size when none is given
+#define DISK_CACHE_DEFAULT_BYTES (64 << 20)
+
+// Queued frontier vertices whose lists are read ahead of the search
+#define DISK_READAHEAD 64
+
+// Rough bytes per edge while a build partition is sorted in memory
+#define DISK_BUILD_EDGE_BYTES 64
+
+typedef struct DiskEdge {
+    int dest;
+    int weight;
+} DiskEdge;
+
+// An adjacency file opened for queries. Out- and in-lists are stored as
+// DiskEdge records sorted by vertex id and then by neighbour id. Only the
+// per-vertex record offsets and the URL dictionary live in memory; the
+// records are read in DISK_BLOCK_SIZE blocks through a CLOCK cache that
+// all threads share.
+typedef struct DiskGraph {
+    int fd;
+    int numVertices;
+    int maxDegree;
+    long long numEdges;
+    long long* outOffsets;  // first record of each vertex, numVertices + 1 entries
+    long long* inOffsets;
+    long long outStart;     // file position of the first out record
+    long long inStart;
+    UrlDict* urlDict;
+    int* urlRank;
+    int* rankVertex;
+
+    pthread_mutex_t lock;
+    int numBlocks;
+    unsigned char* blocks;
+    long long* blockTag;    // file block held by each slot, -1 if empty
+    char* referenced;
+    int* bucket;            // hash of file block -> first slot in its chain
+    int* chain;
+    int numBuckets;
+    int hand;
+    long hits;
+    long misses;
+    long readaheads;
+} DiskGraph;
+
+long long buildDiskGraph(const char* linksFile, const char* diskFile, int maxUrlLength,
+                         DuplicatePolicy policy, size_t memoryBudget);
+DiskGraph* openDiskGraph(const char* filename, size_t cacheBytes, size_t budget);
+int diskGraphNeighbours(DiskGraph* disk, int v, int forward, DiskEdge* edges);
+int diskGraphFindWeight(DiskGraph* disk, int u, int v);
+void diskGraphReadahead(DiskGraph* disk, const int* vertices, int count, int forward);
+size_t diskGraphBytes(const DiskGraph* disk);
+void printDiskCacheStats(DiskGraph* disk);
+void closeDiskGraph(DiskGraph* disk);
+
+#endif
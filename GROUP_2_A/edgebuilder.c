@@ -0,0 +1,272 @@
+#include <pthread.h>
+#include <unistd.h>
+#include "edgebuilder.h"
+
+typedef struct SortChunk {
+    const int* keys;
+    const int* in;
+    int* out;
+    int* counts;
+    int begin;
+    int end;
+} SortChunk;
+
+int parseDuplicatePolicy(const char* name, DuplicatePolicy* policy) {
+    if (strcmp(name, "sum") == 0) *policy = DUPLICATE_SUM;
+    else if (strcmp(name, "max") == 0) *policy = DUPLICATE_MAX;
+    else if (strcmp(name, "last") == 0) *policy = DUPLICATE_LAST;
+    else return 0;
+    return 1;
+}
+
+EdgeBuilder* createEdgeBuilder(int capacity) {
+    EdgeBuilder* builder = (EdgeBuilder*)malloc(sizeof(EdgeBuilder));
+    if (!builder) return NULL;
+    if (capacity < 16) capacity = 16;
+
+    builder->src = (int*)malloc(capacity * sizeof(int));
+    builder->dest = (int*)malloc(capacity * sizeof(int));
+    builder->weight = (int*)malloc(capacity * sizeof(int));
+    builder->numEdges = 0;
+    builder->capacity = capacity;
+
+    if (!builder->src || !builder->dest || !builder->weight) {
+        freeEdgeBuilder(builder);
+        return NULL;
+    }
+    return builder;
+}
+
+int edgeBuilderAdd(EdgeBuilder* builder, int src, int dest, int weight) {
+    if (builder->numEdges == builder->capacity) {
+        int capacity = builder->capacity * 2;
+        int* newSrc = (int*)realloc(builder->src, capacity * sizeof(int));
+        if (!newSrc) return 0;
+        builder->src = newSrc;
+        int* newDest = (int*)realloc(builder->dest, capacity * sizeof(int));
+        if (!newDest) return 0;
+        builder->dest = newDest;
+        int* newWeight = (int*)realloc(builder->weight, capacity * sizeof(int));
+        if (!newWeight) return 0;
+        builder->weight = newWeight;
+        builder->capacity = capacity;
+    }
+
+    builder->src[builder->numEdges] = src;
+    builder->dest[builder->numEdges] = dest;
+    builder->weight[builder->numEdges] = weight;
+    builder->numEdges++;
+    return 1;
+}
+
+static void* countChunk(void* arg) {
+    SortChunk* chunk = (SortChunk*)arg;
+    for (int i = chunk->begin; i < chunk->end; i++) {
+        chunk->counts[chunk->keys[chunk->in[i]]]++;
+    }
+    return NULL;
+}
+
+static void* scatterChunk(void* arg) {
+    SortChunk* chunk = (SortChunk*)arg;
+    for (int i = chunk->begin; i < chunk->end; i++) {
+        int idx = chunk->in[i];
+        chunk->out[chunk->counts[chunk->keys[idx]]++] = idx;
+    }
+    return NULL;
+}
+
+static void runChunks(SortChunk* chunks, int numThreads, void* (*fn)(void*)) {
+    pthread_t threads[numThreads];
+    int started = 0;
+
+    for (int t = 1; t < numThreads; t++) {
+        if (pthread_create(&threads[t], NULL, fn, &chunks[t]) != 0) break;
+        started = t;
+    }
+    fn(&chunks[0]);
+    for (int t = 1; t <= started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    // Any chunk whose thread could not be started runs here instead
+    for (int t = started + 1; t < numThreads; t++) {
+        fn(&chunks[t]);
+    }
+}
+
+// Stable counting sort of the index array 'in' by keys[in[i]] into 'out'.
+// Each thread counts and scatters a contiguous slice, and slices are laid
+// out in thread order inside every bucket, so the result is deterministic.
+static int countingSortPass(const int* keys, const int* in, int* out, int n,
+                            int numBuckets, int numThreads) {
+    int* counts = (int*)calloc((size_t)numThreads * numBuckets, sizeof(int));
+    SortChunk* chunks = (SortChunk*)malloc(numThreads * sizeof(SortChunk));
+    if (!counts || !chunks) {
+        free(counts);
+        free(chunks);
+        return 0;
+    }
+
+    for (int t = 0; t < numThreads; t++) {
+        chunks[t].keys = keys;
+        chunks[t].in = in;
+        chunks[t].out = out;
+        chunks[t].counts = counts + (size_t)t * numBuckets;
+        chunks[t].begin = (int)((long long)n * t / numThreads);
+        chunks[t].end = (int)((long long)n * (t + 1) / numThreads);
+    }
+
+    runChunks(chunks, numThreads, countChunk);
+
+    //bucket-major, thread-minor prefix sum
+    int running = 0;
+    for (int b = 0; b < numBuckets; b++) {
+        for (int t = 0; t < numThreads; t++) {
+            int count = chunks[t].counts[b];
+            chunks[t].counts[b] = running;
+            running += count;
+        }
+    }
+
+    runChunks(chunks, numThreads, scatterChunk);
+
+    free(counts);
+    free(chunks);
+    return 1;
+}
+
+static void mergeWeight(int* target, int weight, DuplicatePolicy policy) {
+    switch (policy) {
+        case DUPLICATE_SUM:
+            *target = (*target > INT_MAX - weight) ? INT_MAX : *target + weight;
+            break;
+        case DUPLICATE_MAX:
+            if (weight > *target) *target = weight;
+            break;
+        case DUPLICATE_LAST:
+            *target = weight;
+            break;
+    }
+}
+
+EdgeList* buildEdgeList(EdgeBuilder* builder, int numVertices,
+                        DuplicatePolicy policy, int numThreads) {
+    int n = builder->numEdges;
+
+    for (int i = 0; i < n; i++) {
+        if (builder->src[i] < 0 || builder->src[i] >= numVertices ||
+            builder->dest[i] < 0 || builder->dest[i] >= numVertices) {
+            printf("Error: Edge %d -> %d is outside the %d vertex graph\n",
+                   builder->src[i], builder->dest[i], numVertices);
+            return NULL;
+        }
+    }
+
+    if (numThreads <= 0) numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (numThreads <= 0 || n < PARALLEL_EDGE_THRESHOLD) numThreads = 1;
+
+    EdgeList* list = (EdgeList*)calloc(1, sizeof(EdgeList));
+    int* order = (int*)malloc((n + 1) * sizeof(int));
+    int* scratch = (int*)malloc((n + 1) * sizeof(int));
+    if (!list || !order || !scratch) {
+        free(list);
+        free(order);
+        free(scratch);
+        return NULL;
+    }
+
+    // LSD radix: by dest, then stably by src. Equal (src, dest) pairs keep
+    // their input order, which is what makes DUPLICATE_LAST well defined.
+    for (int i = 0; i < n; i++) scratch[i] = i;
+    if (!countingSortPass(builder->dest, scratch, order, n, numVertices, numThreads) ||
+        !countingSortPass(builder->src, order, scratch, n, numVertices, numThreads)) {
+        free(list);
+        free(order);
+        free(scratch);
+        return NULL;
+    }
+
+    list->numVertices = numVertices;
+    list->outOffsets = (int*)calloc(numVertices + 1, sizeof(int));
+    list->outDest = (int*)malloc((n + 1) * sizeof(int));
+    list->outWeight = (int*)malloc((n + 1) * sizeof(int));
+    list->inOffsets = (int*)calloc(numVertices + 1, sizeof(int));
+    list->inSrc = (int*)malloc((n + 1) * sizeof(int));
+    list->inWeight = (int*)malloc((n + 1) * sizeof(int));
+    if (!list->outOffsets || !list->outDest || !list->outWeight ||
+        !list->inOffsets || !list->inSrc || !list->inWeight) {
+        free(order);
+        free(scratch);
+        freeEdgeList(list);
+        return NULL;
+    }
+
+    //merge runs of equal (src, dest)
+    int m = 0;
+    int* outSrc = order;
+    for (int i = 0; i < n; i++) {
+        int idx = scratch[i];
+        int src = builder->src[idx];
+        int dest = builder->dest[idx];
+        if (m > 0 && outSrc[m - 1] == src && list->outDest[m - 1] == dest) {
+            mergeWeight(&list->outWeight[m - 1], builder->weight[idx], policy);
+            list->numDuplicates++;
+            continue;
+        }
+        outSrc[m] = src;
+        list->outDest[m] = dest;
+        list->outWeight[m] = builder->weight[idx];
+        list->outOffsets[src + 1]++;
+        m++;
+    }
+    list->numEdges = m;
+    for (int v = 0; v < numVertices; v++) {
+        list->outOffsets[v + 1] += list->outOffsets[v];
+    }
+
+    // Reverse adjacency: one more stable pass over the merged edges by dest,
+    // so every in-list comes out sorted by source id
+    for (int i = 0; i < m; i++) scratch[i] = i;
+    int* byDest = (int*)malloc((m + 1) * sizeof(int));
+    if (!byDest || !countingSortPass(list->outDest, scratch, byDest, m,
+                                     numVertices, numThreads)) {
+        free(byDest);
+        free(order);
+        free(scratch);
+        freeEdgeList(list);
+        return NULL;
+    }
+    for (int i = 0; i < m; i++) {
+        int e = byDest[i];
+        list->inSrc[i] = outSrc[e];
+        list->inWeight[i] = list->outWeight[e];
+        list->inOffsets[list->outDest[e] + 1]++;
+    }
+    for (int v = 0; v < numVertices; v++) {
+        list->inOffsets[v + 1] += list->inOffsets[v];
+    }
+
+    free(byDest);
+    free(order);
+    free(scratch);
+    return list;
+}
+
+void freeEdgeBuilder(EdgeBuilder* builder) {
+    if (!builder) return;
+    free(builder->src);
+    free(builder->dest);
+    free(builder->weight);
+    free(builder);
+}
+
+void freeEdgeList(EdgeList* list) {
+    if (!list) return;
+    free(list->outOffsets);
+    free(list->outDest);
+    free(list->outWeight);
+    free(list->inOffsets);
+    free(list->inSrc);
+    free(list->inWeight);
+    free(list);
+}
@@ -0,0 +1,49 @@
+#ifndef EDGEBUILDER_H
+#define EDGEBUILDER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+// Below this many edges the counting sort runs on the calling thread
+#define PARALLEL_EDGE_THRESHOLD 65536
+
+// How repeated src->dest lines are merged into a single edge
+typedef enum DuplicatePolicy {
+    DUPLICATE_SUM,
+    DUPLICATE_MAX,
+    DUPLICATE_LAST
+} DuplicatePolicy;
+
+// Raw (src, dest, weight) triples in input order
+typedef struct EdgeBuilder {
+    int* src;
+    int* dest;
+    int* weight;
+    int numEdges;
+    int capacity;
+} EdgeBuilder;
+
+// Compact forward and reverse adjacency, both sorted by neighbour id
+typedef struct EdgeList {
+    int numVertices;
+    int numEdges;
+    int numDuplicates;
+    int* outOffsets;
+    int* outDest;
+    int* outWeight;
+    int* inOffsets;
+    int* inSrc;
+    int* inWeight;
+} EdgeList;
+
+int parseDuplicatePolicy(const char* name, DuplicatePolicy* policy);
+EdgeBuilder* createEdgeBuilder(int capacity);
+int edgeBuilderAdd(EdgeBuilder* builder, int src, int dest, int weight);
+EdgeList* buildEdgeList(EdgeBuilder* builder, int numVertices,
+                        DuplicatePolicy policy, int numThreads);
+void freeEdgeBuilder(EdgeBuilder* builder);
+void freeEdgeList(EdgeList* list);
+
+#endif
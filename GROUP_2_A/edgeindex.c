@@ -0,0 +1,135 @@
+#include "edgeindex.h"
+
+#define EMPTY_KEY (~0ULL)
+
+static unsigned long long edgeKey(int src, int dest) {
+    return ((unsigned long long)(unsigned int)src << 32) | (unsigned int)dest;
+}
+
+static int hashKey(unsigned long long key, int capacity) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return (int)(key & (unsigned long long)(capacity - 1));
+}
+
+static int allocTable(EdgeIndex* index, int capacity) {
+    index->keys = (unsigned long long*)malloc(capacity * sizeof(unsigned long long));
+    index->slots = (int*)malloc(capacity * sizeof(int));
+    if (!index->keys || !index->slots) {
+        free(index->keys);
+        free(index->slots);
+        return 0;
+    }
+    for (int i = 0; i < capacity; i++) index->keys[i] = EMPTY_KEY;
+    index->capacity = capacity;
+    index->count = 0;
+    return 1;
+}
+
+EdgeIndex* createEdgeIndex(int expectedEdges) {
+    EdgeIndex* index = (EdgeIndex*)malloc(sizeof(EdgeIndex));
+    if (!index) return NULL;
+
+    //keep the load factor at or below one half
+    int capacity = 16;
+    while (capacity < expectedEdges * 2) capacity *= 2;
+    if (!allocTable(index, capacity)) {
+        free(index);
+        return NULL;
+    }
+    return index;
+}
+
+int edgeIndexFind(const EdgeIndex* index, int src, int dest) {
+    unsigned long long key = edgeKey(src, dest);
+    for (int i = hashKey(key, index->capacity);; i = (i + 1) & (index->capacity - 1)) {
+        if (index->keys[i] == key) return index->slots[i];
+        if (index->keys[i] == EMPTY_KEY) return -1;
+    }
+}
+
+static int grow(EdgeIndex* index) {
+    unsigned long long* keys = index->keys;
+    int* slots = index->slots;
+    int capacity = index->capacity;
+    if (!allocTable(index, capacity * 2)) {
+        index->keys = keys;
+        index->slots = slots;
+        return 0;
+    }
+    for (int i = 0; i < capacity; i++) {
+        if (keys[i] == EMPTY_KEY) continue;
+        int j = hashKey(keys[i], index->capacity);
+        while (index->keys[j] != EMPTY_KEY) j = (j + 1) & (index->capacity - 1);
+        index->keys[j] = keys[i];
+        index->slots[j] = slots[i];
+        index->count++;
+    }
+    free(keys);
+    free(slots);
+    return 1;
+}
+
+// Inserts or overwrites the slot of (src, dest). Returns 0 only when the
+// table needed to grow and could not.
+int edgeIndexPut(EdgeIndex* index, int src, int dest, int slot) {
+    unsigned long long key = edgeKey(src, dest);
+    int i = hashKey(key, index->capacity);
+    while (index->keys[i] != EMPTY_KEY && index->keys[i] != key) {
+        i = (i + 1) & (index->capacity - 1);
+    }
+    if (index->keys[i] == EMPTY_KEY) {
+        if (edgeIndexGrowthBytes(index) > 0) {
+            if (!grow(index)) return 0;
+            i = hashKey(key, index->capacity);
+            while (index->keys[i] != EMPTY_KEY) i = (i + 1) & (index->capacity - 1);
+        }
+        index->keys[i] = key;
+        index->count++;
+    }
+    index->slots[i] = slot;
+    return 1;
+}
+
+// Extra bytes the table needs before one more new key can go in
+size_t edgeIndexGrowthBytes(const EdgeIndex* index) {
+    if ((index->count + 1) * 2 <= index->capacity) return 0;
+    return (size_t)index->capacity * (sizeof(unsigned long long) + sizeof(int));
+}
+
+// Backward-shift deletion: later entries of the probe run are moved up so
+// lookups never need tombstones
+void edgeIndexRemove(EdgeIndex* index, int src, int dest) {
+    unsigned long long key = edgeKey(src, dest);
+    int mask = index->capacity - 1;
+    int i = hashKey(key, index->capacity);
+    while (index->keys[i] != key) {
+        if (index->keys[i] == EMPTY_KEY) return;
+        i = (i + 1) & mask;
+    }
+
+    for (int j = (i + 1) & mask; index->keys[j] != EMPTY_KEY; j = (j + 1) & mask) {
+        int home = hashKey(index->keys[j], index->capacity);
+        //move j into the hole unless its home lies cyclically in (i, j]
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            index->keys[i] = index->keys[j];
+            index->slots[i] = index->slots[j];
+            i = j;
+        }
+    }
+    index->keys[i] = EMPTY_KEY;
+    index->count--;
+}
+
+size_t edgeIndexBytes(const EdgeIndex* index) {
+    return sizeof(EdgeIndex) +
+           (size_t)index->capacity * (sizeof(unsigned long long) + sizeof(int));
+}
+
+void freeEdgeIndex(EdgeIndex* index) {
+    if (!index) return;
+    free(index->keys);
+    free(index->slots);
+    free(index);
+}
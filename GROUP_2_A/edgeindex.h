@@ -0,0 +1,45 @@
+#ifndef EDGEINDEX_H
+#define EDGEINDEX_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Number of applied updates after which edge lists are compacted again
+#define EDGE_COMPACT_INTERVAL 1024
+
+// Update lines applied per write-locked batch when streaming from a file
+#define UPDATE_BATCH_SIZE 256
+
+// Open-addressing hash from a (src, dest) pair to the slot of that edge
+// in src's edge array, so updates can find an edge without scanning
+typedef struct EdgeIndex {
+    unsigned long long* keys;
+    int* slots;
+    int capacity;
+    int count;
+} EdgeIndex;
+
+typedef enum EdgeUpdateType {
+    EDGE_INSERT,
+    EDGE_DELETE,
+    EDGE_SET_WEIGHT
+} EdgeUpdateType;
+
+// One streamed change; EDGE_INSERT on an existing edge replaces its weight
+typedef struct EdgeUpdate {
+    EdgeUpdateType type;
+    int src;
+    int dest;
+    int weight;
+} EdgeUpdate;
+
+EdgeIndex* createEdgeIndex(int expectedEdges);
+int edgeIndexFind(const EdgeIndex* index, int src, int dest);
+int edgeIndexPut(EdgeIndex* index, int src, int dest, int slot);
+void edgeIndexRemove(EdgeIndex* index, int src, int dest);
+size_t edgeIndexGrowthBytes(const EdgeIndex* index);
+size_t edgeIndexBytes(const EdgeIndex* index);
+void freeEdgeIndex(EdgeIndex* index);
+
+#endif
@@ -1,328 +1,709 @@
+#include <time.h>
 #include "edgraph.h"
 
-Graph* createGraph(int vertices) {
-    Graph* graph = (Graph*)malloc(sizeof(Graph));
-    graph->numVertices = vertices;
-    graph->nodes = (Node*)malloc(vertices * sizeof(Node));
+int min(int a, int b) {
+    return (a < b) ? a : b;
+}
 
-    //adjacency matrix
-    graph->adjMatrix = (int**)malloc(vertices * sizeof(int*));
-    for (int i = 0; i < vertices; i++) {
-        graph->adjMatrix[i] = (int*)calloc(vertices, sizeof(int));
-        graph->nodes[i].vertex = i;
-        graph->nodes[i].url = NULL;
-        graph->nodes[i].edges = NULL;
-        graph->nodes[i].numEdges = 0;
-    }
+long long edmondsKarp(Graph* graph, const char* source_url, const char* sink_url) {
+    return edmondsKarpMulti(graph, &source_url, 1, &sink_url, 1, NULL);
+}
 
-    return graph;
+// Largest power of two not above the largest edge capacity
+static int initialDelta(Graph* graph) {
+    int maxCapacity = 0;
+    for (int i = 0; i < graph->numVertices; i++) {
+        EdgeCursor cursor;
+        int v, weight;
+        outEdgesBegin(graph, i, &cursor);
+        while (outEdgesNext(&cursor, &v, &weight)) {
+            if (weight > maxCapacity) maxCapacity = weight;
+        }
+    }
+    int delta = 1;
+    while (delta <= maxCapacity / 2) delta *= 2;
+    return delta;
 }
 
-void addEdge(Graph* graph, int src, int dest, int weight) {
-    // Add to edges list
-    Edge* edge = (Edge*)malloc(sizeof(Edge));
-    edge->dest = dest;
-    edge->weight = weight;
+// Scratch for decomposing the converged flow: flow[a] is what is still
+// unassigned on arc a, nextArc[u] skips u's arcs that are used up and
+// onWalk[u] is u's position on the current walk, or -1
+typedef struct FlowWalk {
+    long long* flow;
+    int* nextArc;
+    int* onWalk;
+    int* vertices;
+    int* arcs;
+    int length;
+} FlowWalk;
+
+static int nextFlowArc(FlowNetwork* net, FlowWalk* walk, int u) {
+    while (walk->nextArc[u] < net->offsets[u + 1] && walk->flow[walk->nextArc[u]] == 0) {
+        walk->nextArc[u]++;
+    }
+    return walk->nextArc[u] < net->offsets[u + 1] ? walk->nextArc[u] : -1;
+}
 
-    graph->nodes[src].edges = (Edge*)realloc(graph->nodes[src].edges, 
-        (graph->nodes[src].numEdges + 1) * sizeof(Edge));
-    graph->nodes[src].edges[graph->nodes[src].numEdges++] = *edge;
-    free(edge);
+// Records vertices[from..length-1] (plus the closing vertex for a path)
+// carrying the bottleneck of arcs[from..], and takes that flow off them
+static int emitFlowPath(FlowReport* report, FlowWalk* walk, int from, int isCycle) {
+    long long amount = LLONG_MAX;
+    for (int i = from; i < walk->length; i++) {
+        if (walk->flow[walk->arcs[i]] < amount) amount = walk->flow[walk->arcs[i]];
+    }
+    for (int i = from; i < walk->length; i++) walk->flow[walk->arcs[i]] -= amount;
 
-    //adjacency matrix
-    graph->adjMatrix[src][dest] = weight;
+    if (report->numPaths == report->pathCapacity) {
+        int capacity = report->pathCapacity ? report->pathCapacity * 2 : 16;
+        FlowPath* grown = (FlowPath*)realloc(report->paths, capacity * sizeof(FlowPath));
+        if (!grown) return 0;
+        report->paths = grown;
+        report->pathCapacity = capacity;
+    }
+    FlowPath* path = &report->paths[report->numPaths];
+    path->length = walk->length - from + (isCycle ? 0 : 1);
+    path->vertices = (int*)malloc(path->length * sizeof(int));
+    if (!path->vertices) return 0;
+    memcpy(path->vertices, walk->vertices + from, path->length * sizeof(int));
+    path->flow = amount;
+    path->isCycle = isCycle;
+    report->numPaths++;
+    return 1;
 }
 
-int findVertexByUrl(Graph* graph, const char* url) {
-    for (int i = 0; i < graph->numVertices; i++) {
-        if (graph->nodes[i].url && strcmp(graph->nodes[i].url, url) == 0) {
-            return i;
+// Follows unassigned flow out of start until it hits a sink (a path) or
+// runs back into itself (a cycle, which is peeled off before carrying
+// on). Every emitted path or cycle empties at least one arc, so all walks
+// together cost O(VE).
+static int walkFlow(FlowNetwork* net, FlowWalk* walk, FlowReport* report,
+                    int start, const char* isSink) {
+    int ok = 1;
+    walk->length = 0;
+    walk->vertices[0] = start;
+    walk->onWalk[start] = 0;
+
+    while (ok) {
+        int u = walk->vertices[walk->length];
+        if (isSink && isSink[u] && walk->length > 0) {
+            ok = emitFlowPath(report, walk, 0, 0);
+            break;
+        }
+        // Conservation rules out dead ends; give up rather than loop
+        int a = nextFlowArc(net, walk, u);
+        if (a == -1) {
+            ok = 0;
+            break;
         }
+
+        int v = net->arcDest[a];
+        walk->arcs[walk->length] = a;
+        if (walk->onWalk[v] != -1) {
+            int from = walk->onWalk[v];
+            walk->length++;
+            ok = emitFlowPath(report, walk, from, 1);
+            walk->length--;
+            for (int i = from + 1; i <= walk->length; i++) walk->onWalk[walk->vertices[i]] = -1;
+            walk->length = from;
+            continue;
+        }
+        walk->vertices[++walk->length] = v;
+        walk->onWalk[v] = walk->length;
     }
-    return -1;
+
+    for (int i = 0; i <= walk->length; i++) walk->onWalk[walk->vertices[i]] = -1;
+    return ok;
 }
 
-void processUrlFile(Graph* graph, const char* filename) {
-    FILE* file = fopen(filename, "r");
-    if (!file) {
-        printf("Error: Cannot open file '%s'\n", filename);
-        return;
+// Residual capacity of the best cut among the BFS level sets
+// {v : dist(v) <= k} of the residual graph, for every k short of the
+// nearest sink; inCut receives that set. Every level set holds the
+// sources and no sink, so flow + the result bounds the maximum flow from
+// above, and once no sink is reachable it is 0 and the cut is minimum.
+// One sweep, O(V + E).
+static long long residualCutBound(FlowNetwork* net, const int* sources, int numSources,
+                                  const char* isSink, char* inCut) {
+    int n = net->numVertices;
+    int* level = (int*)malloc(n * sizeof(int));
+    long long* change = (long long*)calloc(n + 2, sizeof(long long));
+    if (!level || !change) {
+        free(level);
+        free(change);
+        return -1;
     }
 
-    char fromUrl[MAX_URL_LENGTH], toUrl[MAX_URL_LENGTH];
-    int weight;
-    int nextVertex = 0;
-    char line[MAX_URL_LENGTH * 2 + 50];  // Buffer for whole line
-    
-    printf("Starting to read file '%s'...\n", filename);
-    
-    while (fgets(line, sizeof(line), file)) {
-        line[strcspn(line, "\n")] = '\0';
-        
-        char* fromUrlToken = strtok(line, ",");
-        char* toUrlToken = strtok(NULL, ",");
-        char* weightToken = strtok(NULL, ",");
-        
-        if (fromUrlToken && toUrlToken && weightToken) {
-            weight = atoi(weightToken);
-            
-            strncpy(fromUrl, fromUrlToken, MAX_URL_LENGTH - 1);
-            strncpy(toUrl, toUrlToken, MAX_URL_LENGTH - 1);
-            fromUrl[MAX_URL_LENGTH - 1] = '\0';
-            toUrl[MAX_URL_LENGTH - 1] = '\0';
-            
-            if (strlen(fromUrl) >= MAX_URL_LENGTH || strlen(toUrl) >= MAX_URL_LENGTH) {
-                printf("Warning: URL too long, skipping line\n");
-                continue;
-            }
-            
-            if (weight < 0) {
-                printf("Warning: Negative weight found, using absolute value\n");
-                weight = abs(weight);
-            }
-            
-            int fromIndex = findVertexByUrl(graph, fromUrl);
-            if (fromIndex == -1) {
-                if (nextVertex >= MAX_VERTICES) {
-                    printf("Error: Maximum number of vertices reached\n");
-                    break;
-                }
-                fromIndex = nextVertex++;
-                graph->nodes[fromIndex].url = strdup(fromUrl);
-                printf("Created new vertex for %s at index %d\n", fromUrl, fromIndex);
-            }
-
-            int toIndex = findVertexByUrl(graph, toUrl);
-            if (toIndex == -1) {
-                if (nextVertex >= MAX_VERTICES) {
-                    printf("Error: Maximum number of vertices reached\n");
-                    break;
-                }
-                toIndex = nextVertex++;
-                graph->nodes[toIndex].url = strdup(toUrl);
-                printf("Created new vertex for %s at index %d\n", toUrl, toIndex);
-            }
+    int front = 0, rear = 0, sinkLevel = INT_MAX;
+    for (int v = 0; v < n; v++) level[v] = -1;
+    for (int i = 0; i < numSources; i++) {
+        if (level[sources[i]] != -1) continue;
+        level[sources[i]] = 0;
+        net->queue[rear++] = sources[i];
+    }
+    while (front < rear) {
+        int u = net->queue[front++];
+        if (isSink[u]) {
+            if (level[u] < sinkLevel) sinkLevel = level[u];
+            continue;
+        }
+        for (int a = net->offsets[u]; a < net->offsets[u + 1]; a++) {
+            int v = net->arcDest[a];
+            if (level[v] != -1 || flowNetworkResidual(net, a) == 0) continue;
+            level[v] = level[u] + 1;
+            net->queue[rear++] = v;
+        }
+    }
+    int maxLevel = level[net->queue[rear - 1]];
+    int lastCut = sinkLevel == INT_MAX ? maxLevel : sinkLevel - 1;
 
-            addEdge(graph, fromIndex, toIndex, weight);
-            printf("Added edge: %s -> %s (Weight: %d)\n", fromUrl, toUrl, weight);
-        } else {
-            printf("Warning: Invalid line format: %s\n", line);
+    // An arc u->v crosses every level set k with level(u) <= k < level(v)
+    for (int u = 0; u < n; u++) {
+        if (level[u] == -1 || level[u] > lastCut) continue;
+        for (int a = net->offsets[u]; a < net->offsets[u + 1]; a++) {
+            int v = net->arcDest[a];
+            int to = (level[v] == -1 || level[v] > lastCut + 1) ? lastCut + 1 : level[v];
+            if (to <= level[u]) continue;
+            long long r = (long long)flowNetworkResidual(net, a);
+            change[level[u]] += r;
+            change[to] -= r;
         }
     }
-    
-    if (ferror(file)) {
-        printf("Error: Failed to read file\n");
-    } else if (feof(file)) {
-        printf("Finished reading file. Processed %d vertices\n", nextVertex);
+    long long best = -1, crossing = 0;
+    int bestLevel = 0;
+    for (int k = 0; k <= lastCut; k++) {
+        crossing += change[k];
+        if (best < 0 || crossing < best) {
+            best = crossing;
+            bestLevel = k;
+        }
     }
-    
-    fclose(file);
+
+    for (int v = 0; v < n; v++) inCut[v] = level[v] != -1 && level[v] <= bestLevel;
+    free(level);
+    free(change);
+    return best;
 }
 
-int min(int a, int b) {
-    return (a < b) ? a : b;
+static double secondsSince(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
 }
 
-// Implements BFS
-int bfs(Graph* graph, int* parent, int source, int sink) {
-    // Initialize visited array
-    int* visited = (int*)calloc(graph->numVertices, sizeof(int));
-    if (!visited) return 0;
-    
-    //queue for BFS
-    int* queue = (int*)malloc(graph->numVertices * sizeof(int));
-    if (!queue) {
-        free(visited);
-        return 0;
+// Lists the edges leaving inCut, the source side of the cut found by
+// residualCutBound, and splits the flow into paths and cycles. The flow
+// on each arc is what its capacity lost.
+static int buildFlowReport(Graph* graph, FlowNetwork* net, const int* sources,
+                           int numSources, const char* isSink, const char* inCut,
+                           FlowReport* report) {
+    int n = net->numVertices;
+    for (int u = 0; u < n; u++) {
+        if (!inCut[u]) continue;
+        for (int a = net->offsets[u]; a < net->offsets[u + 1]; a++) {
+            int v = net->arcDest[a];
+            int capacity = graph->adjMatrix[u][v];
+            if (inCut[v] || capacity <= 0) continue;
+            if (report->numCutEdges == report->cutCapacity) {
+                int grow = report->cutCapacity ? report->cutCapacity * 2 : 16;
+                CutEdge* grown = (CutEdge*)realloc(report->cut, grow * sizeof(CutEdge));
+                if (!grown) return 0;
+                report->cut = grown;
+                report->cutCapacity = grow;
+            }
+            report->cut[report->numCutEdges].src = u;
+            report->cut[report->numCutEdges].dest = v;
+            report->cut[report->numCutEdges].capacity = capacity;
+            report->numCutEdges++;
+            report->cutValue += capacity;
+        }
     }
-    int front = 0, rear = 0;
-    
-    // Start BFS
-    visited[source] = 1;
-    queue[rear++] = source;
-    parent[source] = -1;
-    
-    //BFS loop
-    while (front < rear) {
-        int u = queue[front++];
-        
-        //adjacent vertices
-        for (int v = 0; v < graph->numVertices; v++) {
-            // If not visited and has capacity
-            if (!visited[v] && graph->adjMatrix[u][v] > 0) {
-                visited[v] = 1;
-                queue[rear++] = v;
-                parent[v] = u;
-                
-                if (v == sink) {
-                    free(visited);
-                    free(queue);
-                    return 1;
-                }
+
+    FlowWalk walk;
+    walk.flow = (long long*)malloc((net->numArcs + 1) * sizeof(long long));
+    walk.nextArc = (int*)malloc(n * sizeof(int));
+    walk.onWalk = (int*)malloc(n * sizeof(int));
+    walk.vertices = (int*)malloc((n + 1) * sizeof(int));
+    walk.arcs = (int*)malloc((n + 1) * sizeof(int));
+    int ok = walk.flow && walk.nextArc && walk.onWalk && walk.vertices && walk.arcs;
+
+    if (ok) {
+        for (int u = 0; u < n; u++) {
+            walk.nextArc[u] = net->offsets[u];
+            walk.onWalk[u] = -1;
+            for (int a = net->offsets[u]; a < net->offsets[u + 1]; a++) {
+                long long capacity = graph->adjMatrix[u][net->arcDest[a]];
+                if (capacity < 0) capacity = 0;
+                long long used = capacity - (long long)flowNetworkResidual(net, a);
+                walk.flow[a] = used > 0 ? used : 0;
+            }
+        }
+        // Source-to-sink paths first; whatever is left circulates
+        for (int i = 0; i < numSources && ok; i++) {
+            while (ok && nextFlowArc(net, &walk, sources[i]) != -1) {
+                ok = walkFlow(net, &walk, report, sources[i], isSink);
+            }
+        }
+        for (int u = 0; u < n && ok; u++) {
+            while (ok && nextFlowArc(net, &walk, u) != -1) {
+                ok = walkFlow(net, &walk, report, u, NULL);
             }
         }
     }
-    
-    free(visited);
-    free(queue);
-    return 0;
+
+    free(walk.flow);
+    free(walk.nextArc);
+    free(walk.onWalk);
+    free(walk.vertices);
+    free(walk.arcs);
+    return ok;
 }
 
-int edmondsKarp(Graph* graph, const char* source_url, const char* sink_url) {
-    int source = findVertexByUrl(graph, source_url);
-    int sink = findVertexByUrl(graph, sink_url);
-    
-    if (source == -1 || sink == -1) {
-        printf("Error: Source or sink URL not found in graph\n");
+static long long maxFlowLocked(Graph* graph, const char** source_urls, int numSources,
+                               const char** sink_urls, int numSinks, const FlowOptions* options) {
+    char urlBuf[MAX_URL_LENGTH];
+    int quiet = options && options->quiet;
+    FlowReport* report = options ? options->report : NULL;
+    FlowBounds* bounds = options ? options->bounds : NULL;
+    double deadline = options ? options->deadlineSeconds : 0;
+    double epsilon = options ? options->epsilon : 0;
+    QueryContext* ctx = options ? options->context : NULL;
+    if (report) memset(report, 0, sizeof(FlowReport));
+    if (bounds) memset(bounds, 0, sizeof(FlowBounds));
+    if (graph->disk) {
+        printf("Error: Maximum flow needs the graph in memory, not on disk\n");
         return -1;
     }
-    
-    //residual graph
-    int** residual = (int**)malloc(graph->numVertices * sizeof(int*));
-    if (!residual) return -1;
-    
-    for (int i = 0; i < graph->numVertices; i++) {
-        residual[i] = (int*)malloc(graph->numVertices * sizeof(int));
-        if (!residual[i]) {
-            for (int j = 0; j < i; j++) free(residual[j]);
-            free(residual);
+    if (numSources <= 0 || numSinks <= 0) {
+        printf("Error: At least one source and one sink URL are required\n");
+        return -1;
+    }
+
+    int* sources = (int*)malloc(numSources * sizeof(int));
+    int* sinks = (int*)malloc(numSinks * sizeof(int));
+    char* isSink = (char*)calloc(graph->numVertices, sizeof(char));
+    if (!sources || !sinks || !isSink) {
+        free(sources);
+        free(sinks);
+        free(isSink);
+        return -1;
+    }
+
+    for (int i = 0; i < numSources; i++) {
+        sources[i] = findVertexByUrl(graph, source_urls[i]);
+        if (sources[i] == -1) {
+            printf("Error: Source URL '%s' not found in graph\n", source_urls[i]);
+            free(sources);
+            free(sinks);
+            free(isSink);
+            return -1;
+        }
+    }
+    for (int i = 0; i < numSinks; i++) {
+        sinks[i] = findVertexByUrl(graph, sink_urls[i]);
+        if (sinks[i] == -1) {
+            printf("Error: Sink URL '%s' not found in graph\n", sink_urls[i]);
+            free(sources);
+            free(sinks);
+            free(isSink);
+            return -1;
+        }
+        isSink[sinks[i]] = 1;
+    }
+    for (int i = 0; i < numSources; i++) {
+        if (isSink[sources[i]]) {
+            printf("Error: %s is both a source and a sink\n", getVertexUrl(graph, sources[i], urlBuf));
+            free(sources);
+            free(sinks);
+            free(isSink);
             return -1;
         }
-        memcpy(residual[i], graph->adjMatrix[i], graph->numVertices * sizeof(int));
     }
     
-    // Parent array for storing BFS path
-    int* parent = (int*)malloc(graph->numVertices * sizeof(int));
-    if (!parent) {
-        for (int i = 0; i < graph->numVertices; i++) free(residual[i]);
-        free(residual);
+    // If the index shows no source can reach any sink the flow is 0
+    // without a single BFS
+    if (graph->reachIndex) {
+        int reachable = 0;
+        for (int i = 0; i < numSources && !reachable; i++) {
+            for (int j = 0; j < numSinks && !reachable; j++) {
+                reachable = reachIndexMayReach(graph->reachIndex, sources[i], sinks[j]);
+            }
+        }
+        if (!reachable) {
+            printf("No augmenting path can exist: the sinks are unreachable from the sources\n");
+            if (bounds) bounds->complete = 1;
+            free(sources);
+            free(sinks);
+            free(isSink);
+            return 0;
+        }
+    }
+    free(sinks);
+    
+    // Arcs carry whatever the matrix holds in both directions, so a flow
+    // started on an already used residual graph continues from it
+    EdgeBuilder* arcs = createEdgeBuilder(graph->numVertices);
+    if (!arcs) {
+        free(sources);
+        free(isSink);
+        return -1;
+    }
+    for (int u = 0; u < graph->numVertices; u++) {
+        EdgeCursor cursor;
+        int v, weight;
+        outEdgesBegin(graph, u, &cursor);
+        while (outEdgesNext(&cursor, &v, &weight)) {
+            if (!edgeBuilderAdd(arcs, u, v, graph->adjMatrix[u][v]) ||
+                !edgeBuilderAdd(arcs, v, u, graph->adjMatrix[v][u])) {
+                printf("Error: Not enough memory to build the flow network\n");
+                freeEdgeBuilder(arcs);
+                free(sources);
+                free(isSink);
+                return -1;
+            }
+        }
+    }
+    // Reserve the worst case before building; the same amounts are
+    // released when the flow is done
+    size_t residualBytes = flowNetworkResidualBytes(graph->numVertices, arcs->numEdges);
+    size_t searchBytes = flowNetworkSearchBytes(graph->numVertices);
+    if (!memReserve(&graph->memory, MEM_RESIDUAL, residualBytes)) {
+        printf("Error: The residual network needs %zu bytes, over the memory budget\n", residualBytes);
+        freeEdgeBuilder(arcs);
+        free(sources);
+        free(isSink);
+        return -1;
+    }
+    if (!memReserve(&graph->memory, MEM_SEARCH, searchBytes)) {
+        printf("Error: The flow search needs %zu bytes, over the memory budget\n", searchBytes);
+        memRelease(&graph->memory, MEM_RESIDUAL, residualBytes);
+        freeEdgeBuilder(arcs);
+        free(sources);
+        free(isSink);
         return -1;
     }
+    FlowNetwork* net = createFlowNetwork(graph->numVertices, arcs);
+    freeEdgeBuilder(arcs);
+    if (!net) {
+        printf("Error: Not enough memory to build the flow network\n");
+        memRelease(&graph->memory, MEM_RESIDUAL, residualBytes);
+        memRelease(&graph->memory, MEM_SEARCH, searchBytes);
+        free(sources);
+        free(isSink);
+        return -1;
+    }
+    if (!quiet) {
+        printf("Flow network: %d arcs with %s residual capacities\n",
+               net->numArcs, capacityWidthName(net->width));
+    }
     
-    int max_flow = 0;
+    long long max_flow = 0;
+    int sink;
+    int augmentations = 0;
+    int stopped = 0;
+    int interrupted = 0;
+    struct timespec started;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    char* inCut = (char*)malloc(graph->numVertices);
+    if (!inCut) epsilon = 0;
+    if (ctx) startQuery(ctx);
     
-    while (bfs(graph, parent, source, sink)) {
-        // Find minimum residual capacity along the path
-        int path_flow = INT_MAX;
-        for (int v = sink; v != source; v = parent[v]) {
-            int u = parent[v];
-            path_flow = min(path_flow, graph->adjMatrix[u][v]);
+    // Capacity scaling: only augment along arcs with residual >= delta and
+    // halve delta once none are left. The final delta = 1 phase is plain
+    // Edmonds-Karp, so the result is still exact.
+    int delta = (options && options->capacityScaling) ? initialDelta(graph) : 1;
+    
+    for (; delta >= 1 && !stopped && !interrupted; delta /= 2) {
+        if (options && options->capacityScaling && !quiet) {
+            printf("Scaling phase: delta = %d\n", delta);
         }
-        
-        // Update residual capacities and reverse edges
-        for (int v = sink; v != source; v = parent[v]) {
-            int u = parent[v];
-            graph->adjMatrix[u][v] -= path_flow;
-            graph->adjMatrix[v][u] += path_flow;
+    
+        // Each path runs from whichever source started it (parent -1) to
+        // whichever sink was reached first
+        while (1) {
+            if (queryExpired(ctx)) {
+                interrupted = 1;
+                break;
+            }
+            sink = flowNetworkBfs(net, sources, numSources, isSink, delta);
+            if (ctx) {
+                ctx->settled += net->lastSettled;
+                ctx->scanned += net->lastScanned;
+            }
+            if (sink == -1) break;
+            
+            unsigned long long path_flow = flowNetworkAugment(net, sink);
+            max_flow += path_flow;
+            augmentations++;
+            if (!quiet) {
+                printf("Found augmenting path with flow: %llu\n", path_flow);
+                printf("Path: %s", getVertexUrl(graph, sink, urlBuf));
+                for (int v = sink; net->parent[v] != -1; v = net->parent[v]) {
+                    printf(" <- %s", getVertexUrl(graph, net->parent[v], urlBuf));
+                }
+                printf("\nCurrent max flow: %lld\n\n", max_flow);
+            }
+            
+            // Anytime mode: the flow so far is always feasible, so it can
+            // be returned as soon as time runs out or it is provably
+            // within (1 - epsilon) of the maximum. The bound costs one
+            // more residual sweep per augmentation.
+            if (deadline > 0 && secondsSince(&started) >= deadline) {
+                stopped = 1;
+                break;
+            }
+            if (epsilon > 0) {
+                long long upper = residualCutBound(net, sources, numSources, isSink, inCut);
+                if (upper >= 0 && max_flow >= (1 - epsilon) * (double)(max_flow + upper)) {
+                    stopped = 1;
+                    break;
+                }
+            }
         }
-        
-        max_flow += path_flow;
-        
-        printf("Found augmenting path with flow: %d\n", path_flow);
-        printf("Path: %s", graph->nodes[sink].url);
-        for (int v = sink; v != source; v = parent[v]) {
-            printf(" <- %s", graph->nodes[parent[v]].url);
+    }
+    
+    // The cut is minimum once no sink is reachable; after an early stop it
+    // is the best level cut of the residual graph and bounds the maximum
+    long long residualCut = -1;
+    if (interrupted) {
+        printQueryStopped(ctx);
+    } else if (inCut && (report || bounds || stopped)) {
+        residualCut = residualCutBound(net, sources, numSources, isSink, inCut);
+    }
+    if (stopped) {
+        printf("Stopped after %d augmenting paths (%.3f s): flow %lld, upper bound %lld\n",
+               augmentations, secondsSince(&started), max_flow,
+               residualCut >= 0 ? max_flow + residualCut : -1);
+    }
+    if (bounds) {
+        bounds->upperBound = residualCut >= 0 ? max_flow + residualCut : -1;
+        bounds->complete = residualCut == 0;
+        bounds->augmentations = augmentations;
+        bounds->seconds = secondsSince(&started);
+    }
+    
+    if (report && !interrupted) {
+        report->maxFlow = max_flow;
+        if (residualCut < 0 ||
+            !buildFlowReport(graph, net, sources, numSources, isSink, inCut, report)) {
+            printf("Error: Could not build the flow decomposition\n");
         }
-        printf("\nCurrent max flow: %d\n\n", max_flow);
     }
+    free(inCut);
     
-    for (int i = 0; i < graph->numVertices; i++) {
-        free(residual[i]);
+    // Hand the residual capacities back to the matrix for the printers and
+    // the cut export; arc residuals never exceed c(u,v) + c(v,u). An
+    // abandoned query leaves the matrix as it was.
+    if (!interrupted && (!options || !options->keepCapacities)) {
+        for (int u = 0; u < net->numVertices; u++) {
+            for (int a = net->offsets[u]; a < net->offsets[u + 1]; a++) {
+                unsigned long long r = flowNetworkResidual(net, a);
+                graph->adjMatrix[u][net->arcDest[a]] = r > INT_MAX ? INT_MAX : (int)r;
+            }
+        }
+        graph->version++;
+    
+        // Reverse arcs now carry capacity, so the index no longer describes
+        // the matrix
+        if (max_flow > 0 && graph->reachIndex) dropReachIndex(graph);
     }
-    free(residual);
-    free(parent);
     
-    return max_flow;
+    memRelease(&graph->memory, MEM_RESIDUAL, residualBytes);
+    memRelease(&graph->memory, MEM_SEARCH, searchBytes);
+    freeFlowNetwork(net);
+    free(sources);
+    free(isSink);
+    
+    return interrupted ? FLOW_INTERRUPTED : max_flow;
 }
 
-void printWeightedEdgeList(Graph* graph) {
-    printf("\n=== Weighted Edge List ===\n");
-    printf("From URL -> To URL (Weight)\n");
-    printf("----------------------------------------\n");
-    for (int i = 0; i < graph->numVertices; i++) {
-        if (graph->nodes[i].url) {  // Only print if URL exists
-            for (int j = 0; j < graph->nodes[i].numEdges; j++) {
-                int destIndex = graph->nodes[i].edges[j].dest;
-                printf("%-30s -> %-30s (Weight: %d)\n",
-                    graph->nodes[i].url,
-                    graph->nodes[destIndex].url,
-                    graph->nodes[i].edges[j].weight);
-            }
-        }
+// The flow rewrites the matrix into its residual graph, so it runs under
+// the write lock like any other batch of updates. With keepCapacities the
+// graph is only read and path queries may run alongside it.
+long long edmondsKarpMulti(Graph* graph, const char** source_urls, int numSources,
+                           const char** sink_urls, int numSinks, const FlowOptions* options) {
+    if (options && options->keepCapacities) {
+        pthread_rwlock_rdlock(&graph->lock);
+    } else {
+        pthread_rwlock_wrlock(&graph->lock);
     }
+    long long maxFlow = maxFlowLocked(graph, source_urls, numSources, sink_urls, numSinks, options);
+    pthread_rwlock_unlock(&graph->lock);
+    return maxFlow;
 }
-void printAdjacencyList(Graph* graph) {
-    printf("\n=== Weighted Adjacency List ===\n");
-    printf("URL -> [Destination URLs]\n");
-    printf("----------------------------------------\n");
-    for (int i = 0; i < graph->numVertices; i++) {
-        if (graph->nodes[i].url) {  // Only print if URL exists
-            printf("%-30s ->", graph->nodes[i].url);
-            for (int j = 0; j < graph->nodes[i].numEdges; j++) {
-                int destIndex = graph->nodes[i].edges[j].dest;
-                printf(" %s (%d)", 
-                    graph->nodes[destIndex].url,
-                    graph->nodes[i].edges[j].weight);
+
+// Flags every vertex reachable from the sources through arcs that still
+// have residual capacity. After edmondsKarp this is the source side of a
+// minimum cut. Residual arcs only run along links, in either direction, so
+// each vertex checks its out- and in-neighbours instead of a matrix row,
+// for O(V + E) in all.
+int residualReachable(Graph* graph, const int* sources, int numSources, char* reached) {
+    int* queue = (int*)malloc(graph->numVertices * sizeof(int));
+    int* inOffsets = NULL;
+    int* inSources = NULL;
+    if (!queue || (!graph->inAdj && !buildReverseLists(graph, &inOffsets, &inSources))) {
+        free(queue);
+        return -1;
+    }
+
+    int front = 0, rear = 0;
+    memset(reached, 0, graph->numVertices);
+    for (int i = 0; i < numSources; i++) {
+        if (reached[sources[i]]) continue;
+        reached[sources[i]] = 1;
+        queue[rear++] = sources[i];
+    }
+    while (front < rear) {
+        int u = queue[front++];
+        EdgeCursor cursor;
+        int v, weight;
+        outEdgesBegin(graph, u, &cursor);
+        while (outEdgesNext(&cursor, &v, &weight)) {
+            if (!reached[v] && graph->adjMatrix[u][v] > 0) {
+                reached[v] = 1;
+                queue[rear++] = v;
+            }
+        }
+        if (graph->inAdj) {
+            AdjIterator it;
+            adjBegin(graph->inAdj, u, &it);
+            while (adjNext(&it, &v, &weight)) {
+                if (!reached[v] && graph->adjMatrix[u][v] > 0) {
+                    reached[v] = 1;
+                    queue[rear++] = v;
+                }
+            }
+        } else {
+            for (int j = inOffsets[u]; j < inOffsets[u + 1]; j++) {
+                v = inSources[j];
+                if (!reached[v] && graph->adjMatrix[u][v] > 0) {
+                    reached[v] = 1;
+                    queue[rear++] = v;
+                }
             }
-            printf("\n");
         }
     }
+
+    free(queue);
+    free(inOffsets);
+    free(inSources);
+    return rear;
 }
 
-void printAdjacencyMatrix(Graph* graph) {
-    printf("\n=== Weighted Adjacency Matrix ===\n");
-    
-    printf("%5s", "");
-    for (int i = 0; i < graph->numVertices; i++) {
-        if (graph->nodes[i].url) {
-            printf("%5d ", i);
-        }
+// Writes the edges of the minimum cut left in the residual graph by the
+// last flow computation, plus everything within hops steps of their
+// endpoints. Cut edges are drawn red, source-side vertices blue. Every
+// step follows links only, so the export is O(V + E) in the worst case.
+void writeCutNeighbourhoodToDot(Graph* graph, const char** source_urls, int numSources,
+                                int hops, const char* filename) {
+    char fromBuf[MAX_URL_LENGTH], toBuf[MAX_URL_LENGTH];
+    if (graph->disk) {
+        printf("Error: DOT export needs the graph in memory, not on disk\n");
+        return;
     }
-    printf("\n%5s", "");
-    
-    for (int i = 0; i < graph->numVertices; i++) {
-        if (graph->nodes[i].url) {
-            printf("------");
+    int* sources = (int*)malloc(numSources * sizeof(int));
+    int* seeds = (int*)malloc(graph->numVertices * sizeof(int));
+    char* reached = (char*)malloc(graph->numVertices);
+    char* inSet = (char*)calloc(graph->numVertices, sizeof(char));
+    if (!sources || !seeds || !reached || !inSet) {
+        free(sources);
+        free(seeds);
+        free(reached);
+        free(inSet);
+        return;
+    }
+
+    int count = 0;
+    for (int i = 0; i < numSources; i++) {
+        int source = findVertexByUrl(graph, source_urls[i]);
+        if (source != -1) sources[count++] = source;
+    }
+    if (residualReachable(graph, sources, count, reached) < 0) {
+        printf("Error: Not enough memory to export the cut\n");
+        free(sources);
+        free(seeds);
+        free(reached);
+        free(inSet);
+        return;
+    }
+
+    //cut endpoints seed the neighbourhood
+    char* isSeed = inSet;
+    int numSeeds = 0;
+    for (int u = 0; u < graph->numVertices; u++) {
+        if (!reached[u]) continue;
+        EdgeCursor cursor;
+        int v, weight;
+        outEdgesBegin(graph, u, &cursor);
+        while (outEdgesNext(&cursor, &v, &weight)) {
+            if (reached[v]) continue;
+            if (!isSeed[u]) { isSeed[u] = 1; seeds[numSeeds++] = u; }
+            if (!isSeed[v]) { isSeed[v] = 1; seeds[numSeeds++] = v; }
         }
     }
-    printf("\n");
-    
-    for (int i = 0; i < graph->numVertices; i++) {
-        if (graph->nodes[i].url) {
-            printf("[%3d] ", i);
-            for (int j = 0; j < graph->numVertices; j++) {
-                if (graph->nodes[j].url) {
-                    printf("%5d ", graph->adjMatrix[i][j]);
-                }
+    memset(inSet, 0, graph->numVertices);
+    collectNeighbourhood(graph, seeds, numSeeds, hops, inSet);
+
+    char* buffer = NULL;
+    FILE* file = openDotFile(filename, &buffer);
+    if (file) {
+        fprintf(file, "digraph MinCut {\n");
+        fprintf(file, "  node [shape=box,style=filled,fillcolor=white];\n");
+        fprintf(file, "  edge [color=gray];\n");
+        for (int u = 0; u < graph->numVertices; u++) {
+            if (!inSet[u] || !hasVertexUrl(graph, u)) continue;
+            const char* url = getVertexUrl(graph, u, fromBuf);
+            fprintf(file, "  \"%s\" [label=\"%s\"%s];\n", url, url,
+                reached[u] ? ",fillcolor=lightblue" : "");
+        }
+        for (int u = 0; u < graph->numVertices; u++) {
+            if (!inSet[u]) continue;
+            EdgeCursor cursor;
+            int v, weight;
+            outEdgesBegin(graph, u, &cursor);
+            while (outEdgesNext(&cursor, &v, &weight)) {
+                if (!inSet[v]) continue;
+                fprintf(file, "  \"%s\" -> \"%s\" [label=\"%d\"%s];\n",
+                    getVertexUrl(graph, u, fromBuf),
+                    getVertexUrl(graph, v, toBuf),
+                    weight,
+                    (reached[u] && !reached[v]) ? ",color=red,penwidth=2.0" : "");
             }
-            printf("\n");
         }
+        fprintf(file, "}\n");
+        closeDotFile(file, buffer);
     }
+
+    free(sources);
+    free(seeds);
+    free(reached);
+    free(inSet);
 }
-void writeGraphToDot(Graph* graph, const char* filename) {
-    FILE* file = fopen(filename, "w");
-    if (!file) return;
 
-    fprintf(file, "digraph G {\n");
-    for (int i = 0; i < graph->numVertices; i++) {
-        for (int j = 0; j < graph->nodes[i].numEdges; j++) {
-            fprintf(file, "  \"%s\" -> \"%s\" [label=\"%d\"];\n",
-                graph->nodes[i].url,
-                graph->nodes[graph->nodes[i].edges[j].dest].url,
-                graph->nodes[i].edges[j].weight);
+void printFlowReport(Graph* graph, const FlowReport* report) {
+    char urlBuf[MAX_URL_LENGTH];
+
+    printf("\n=== Flow Decomposition ===\n");
+    printf("Maximum flow: %lld in %d paths and cycles\n", report->maxFlow, report->numPaths);
+    for (int i = 0; i < report->numPaths; i++) {
+        const FlowPath* path = &report->paths[i];
+        printf("%s\t%lld\t", path->isCycle ? "cycle" : "path", path->flow);
+        for (int j = 0; j < path->length; j++) {
+            printf("%s%s", j > 0 ? " -> " : "", getVertexUrl(graph, path->vertices[j], urlBuf));
         }
+        if (path->isCycle) printf(" -> %s", getVertexUrl(graph, path->vertices[0], urlBuf));
+        printf("\n");
+    }
+
+    printf("\n=== Minimum Cut ===\n");
+    printf("Cut capacity: %lld over %d edges\n", report->cutValue, report->numCutEdges);
+    for (int i = 0; i < report->numCutEdges; i++) {
+        const CutEdge* edge = &report->cut[i];
+        printf("cut\t%d\t%s", edge->capacity, getVertexUrl(graph, edge->src, urlBuf));
+        printf(" -> %s\n", getVertexUrl(graph, edge->dest, urlBuf));
     }
-    fprintf(file, "}\n");
-    fclose(file);
 }
 
-void freeGraph(Graph* graph) {
-    for (int i = 0; i < graph->numVertices; i++) {
-        free(graph->nodes[i].url);
-        free(graph->nodes[i].edges);
-        free(graph->adjMatrix[i]);
-    }
-    free(graph->adjMatrix);
-    free(graph->nodes);
-    free(graph);
-}
\ No newline at end of file
+void freeFlowReport(FlowReport* report) {
+    for (int i = 0; i < report->numPaths; i++) free(report->paths[i].vertices);
+    free(report->paths);
+    free(report->cut);
+    memset(report, 0, sizeof(FlowReport));
+}
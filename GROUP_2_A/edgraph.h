@@ -1,45 +1,72 @@
-#ifndef GRAPH_H
-#define GRAPH_H
+#ifndef EDGRAPH_H
+#define EDGRAPH_H
 
+#include "graph.h"
+#include "flowkernel.h"
 
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <limits.h>
+// One flow-carrying path from a source to a sink, or a cycle whose last
+// vertex links back to the first
+typedef struct FlowPath {
+    int* vertices;
+    int length;
+    int isCycle;
+    long long flow;
+} FlowPath;
 
-#define MAX_URL_LENGTH 256
-#define MAX_VERTICES 100
-
-typedef struct Edge {
+typedef struct CutEdge {
+    int src;
     int dest;
-    int weight;
-} Edge;
-
-typedef struct Node {
-    int vertex;
-    char* url;
-    Edge* edges;
-    int numEdges;
-} Node;
-
-typedef struct Graph {
-    Node* nodes;
-    int numVertices;
-    int** adjMatrix;
-} Graph;
-
-Graph* createGraph(int vertices);
-void addEdge(Graph* graph, int src, int dest, int weight);
-void printAdjacencyList(Graph* graph);
-void printWeightedEdgeList(Graph* graph);
-void printAdjacencyMatrix(Graph* graph);
-int findVertexByUrl(Graph* graph, const char* url);
-void processUrlFile(Graph* graph, const char* filename);
-void writeGraphToDot(Graph* graph, const char* filename);
-void freeGraph(Graph* graph);
+    int capacity;
+} CutEdge;
+
+// Filled in after the flow stops: the flow split into paths and cycles,
+// and the edges of the cut bounding it (a minimum cut if it converged)
+typedef struct FlowReport {
+    long long maxFlow;
+    FlowPath* paths;
+    int numPaths;
+    int pathCapacity;
+    CutEdge* cut;
+    int numCutEdges;
+    int cutCapacity;
+    long long cutValue;
+} FlowReport;
+
+// Where an anytime or approximate flow stopped. The flow returned is a
+// lower bound on the maximum and upperBound the capacity of a cut, so
+// the maximum lies between them; complete means they are equal.
+typedef struct FlowBounds {
+    long long upperBound;
+    int complete;
+    int augmentations;
+    double seconds;
+} FlowBounds;
+
+// Returned instead of a flow when options->context stopped the search
+#define FLOW_INTERRUPTED -2
+
+// deadlineSeconds still returns the flow found so far; a context that
+// expires abandons the query and leaves the graph untouched
+typedef struct FlowOptions {
+    int capacityScaling;
+    int keepCapacities;     // leave the matrix as it was instead of the residual graph
+    int quiet;              // no per-augmentation output
+    FlowReport* report;     // decomposition and minimum cut, if wanted
+    double deadlineSeconds; // stop augmenting after this long (0 = no limit)
+    double epsilon;         // stop once within (1 - epsilon) of the maximum (0 = exact)
+    FlowBounds* bounds;     // where the flow stopped, if wanted
+    QueryContext* context;  // limits and cancellation, polled between augmentations
+} FlowOptions;
+
+int residualReachable(Graph* graph, const int* sources, int numSources, char* reached);
+void writeCutNeighbourhoodToDot(Graph* graph, const char** source_urls, int numSources,
+                                int hops, const char* filename);
 
 int min(int a, int b);
-int bfs(Graph* graph, int* parent, int source, int sink);
-int edmondsKarp(Graph* graph, const char* source_url, const char* sink_url);
+long long edmondsKarp(Graph* graph, const char* source_url, const char* sink_url);
+long long edmondsKarpMulti(Graph* graph, const char** source_urls, int numSources,
+                           const char** sink_urls, int numSinks, const FlowOptions* options);
+void printFlowReport(Graph* graph, const FlowReport* report);
+void freeFlowReport(FlowReport* report);
 
-#endif
\ No newline at end of file
+#endif
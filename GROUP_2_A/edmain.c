@@ -1,8 +1,70 @@
 #include "edgraph.h"
 
-int main() {
-    Graph* graph = createGraph(MAX_VERTICES);
+#define MAX_VERTICES 100
+
+// Splits a comma-separated list of URLs in place, trimming spaces
+static int splitUrlList(char* line, const char** urls, int maxUrls) {
+    int count = 0;
+    for (char* token = strtok(line, ","); token && count < maxUrls; token = strtok(NULL, ",")) {
+        while (*token == ' ') token++;
+        char* end = token + strlen(token);
+        while (end > token && end[-1] == ' ') *--end = '\0';
+        if (*token) urls[count++] = token;
+    }
+    return count;
+}
+
+int main(int argc, char* argv[]) {
+    FlowOptions options = {0};
+    FlowReport report = {0};
+    FlowBounds bounds;
+    VertexOrder order = ORDER_NONE;
+    DuplicatePolicy duplicates = DUPLICATE_LAST;
+    int compress = 0;
+    int dotHops = -1;
+    const char* updatesFile = NULL;
+    size_t memoryBudget = 0;
+    QueryContext limits;
+    initQueryContext(&limits);
+    options.bounds = &bounds;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--scaling") == 0) {
+            options.capacityScaling = 1;
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            options.quiet = 1;
+        } else if (strcmp(argv[i], "--report") == 0) {
+            options.report = &report;
+        } else if (strncmp(argv[i], "--deadline=", 11) == 0) {
+            options.deadlineSeconds = atof(argv[i] + 11) / 1000.0;
+        } else if (strncmp(argv[i], "--epsilon=", 10) == 0) {
+            options.epsilon = atof(argv[i] + 10);
+        } else if (parseQueryLimit(argv[i], &limits)) {
+            options.context = &limits;
+        } else if (strcmp(argv[i], "--compress") == 0) {
+            compress = 1;
+        } else if (strncmp(argv[i], "--dot-hops=", 11) == 0) {
+            dotHops = atoi(argv[i] + 11);
+        } else if (strncmp(argv[i], "--updates=", 10) == 0) {
+            updatesFile = argv[i] + 10;
+        } else if (strncmp(argv[i], "--memory-budget=", 16) == 0) {
+            memoryBudget = (size_t)atol(argv[i] + 16) << 20;
+        } else if (strncmp(argv[i], "--reorder=", 10) == 0 &&
+                   parseVertexOrder(argv[i] + 10, &order)) {
+            continue;
+        } else if (strncmp(argv[i], "--duplicates=", 13) == 0 &&
+                   parseDuplicatePolicy(argv[i] + 13, &duplicates)) {
+            continue;
+        } else {
+            printf("Usage: %s [--scaling] [--quiet] [--report] [--deadline=MS] [--epsilon=E] [--timeout=MS] [--max-settled=N] [--max-scanned=N] [--compress] [--reorder=none|bfs|rcm|degree] [--duplicates=sum|max|last] [--dot-hops=K] [--updates=FILE] [--memory-budget=MB]\n", argv[0]);
+            return 1;
+        }
+    }
+    
+    Graph* graph = createGraphWithBudget(MAX_VERTICES, memoryBudget);
+    if (!graph) return 1;
+    graph->duplicatePolicy = duplicates;
     char filename[256];
+    char urlBuf[MAX_URL_LENGTH];
     
     printf("Enter the filename containing URLs and links: ");
     if (fgets(filename, sizeof(filename), stdin) == NULL) {
@@ -12,20 +74,30 @@ int main() {
     }
     filename[strcspn(filename, "\n")] = '\0';
 
-    FILE* test = fopen(filename, "r");
-    if (!test) {
-        printf("Error: File '%s' does not exist or cannot be opened\n", filename);
-        freeGraph(graph);
-        return 1;
+    // A directory or glob loads all matching shard files in parallel
+    if (isShardPattern(filename)) {
+        processUrlShards(graph, filename);
+    } else {
+        FILE* test = fopen(filename, "r");
+        if (!test) {
+            printf("Error: File '%s' does not exist or cannot be opened\n", filename);
+            freeGraph(graph);
+            return 1;
+        }
+        fclose(test);
+        
+        processUrlFile(graph, filename);
     }
-    fclose(test);
-    
-    processUrlFile(graph, filename);
+    reorderGraph(graph, order);
+    compactUrls(graph);
+    if (compress) compressGraph(graph);
+    buildReachability(graph);
+    if (updatesFile) processUpdateFile(graph, updatesFile);
     
     //print vertices
     int hasVertices = 0;
     for (int i = 0; i < graph->numVertices; i++) {
-        if (graph->nodes[i].url != NULL) {
+        if (hasVertexUrl(graph, i)) {
             hasVertices = 1;
             break;
         }
@@ -40,9 +112,14 @@ int main() {
         
         // Run Edmonds-Karp algorithm
         printf("\n=== Maximum Flow Analysis ===\n");
-        char sourceUrl[MAX_URL_LENGTH], sinkUrl[MAX_URL_LENGTH];
+        // Several URLs may be given per prompt; the flow is then measured
+        // from all sources together into all sinks together
+        char sourceUrl[MAX_URL_LENGTH * 4], sinkUrl[MAX_URL_LENGTH * 4];
+        char sourceList[MAX_URL_LENGTH * 4], sinkList[MAX_URL_LENGTH * 4];
+        const char* sources[MAX_VERTICES];
+        const char* sinks[MAX_VERTICES];
         
-        printf("Enter source URL: ");
+        printf("Enter source URL(s), comma-separated: ");
         if (fgets(sourceUrl, sizeof(sourceUrl), stdin) == NULL) {
             printf("Error reading source URL\n");
             freeGraph(graph);
@@ -50,7 +127,7 @@ int main() {
         }
         sourceUrl[strcspn(sourceUrl, "\n")] = '\0';
         
-        printf("Enter sink URL: ");
+        printf("Enter sink URL(s), comma-separated: ");
         if (fgets(sinkUrl, sizeof(sinkUrl), stdin) == NULL) {
             printf("Error reading sink URL\n");
             freeGraph(graph);
@@ -58,15 +135,29 @@ int main() {
         }
         sinkUrl[strcspn(sinkUrl, "\n")] = '\0';
         
-        int maxFlow = edmondsKarp(graph, sourceUrl, sinkUrl);
+        strcpy(sourceList, sourceUrl);
+        strcpy(sinkList, sinkUrl);
+        int numSources = splitUrlList(sourceList, sources, MAX_VERTICES);
+        int numSinks = splitUrlList(sinkList, sinks, MAX_VERTICES);
+        
+        long long maxFlow = edmondsKarpMulti(graph, sources, numSources, sinks, numSinks, &options);
         if (maxFlow >= 0) {
-            printf("\nMaximum flow from %s to %s: %d\n", sourceUrl, sinkUrl, maxFlow);
+            printf("\nMaximum flow from %s to %s: %lld\n", sourceUrl, sinkUrl, maxFlow);
+            if (!bounds.complete) {
+                printf("Stopped early: the maximum flow is at most %lld\n", bounds.upperBound);
+            }
+            if (options.report) printFlowReport(graph, options.report);
             
             // Print residual graph after max flow calculation
-            printf("\n=== Residual Graph After Maximum Flow ===\n");
-            printWeightedEdgeList(graph);
-            printAdjacencyList(graph);
-            printAdjacencyMatrix(graph);
+            if (!options.quiet) {
+                printf("\n=== Residual Graph After Maximum Flow ===\n");
+                printWeightedEdgeList(graph);
+                printAdjacencyList(graph);
+                printAdjacencyMatrix(graph);
+            }
+        } else if (maxFlow == FLOW_INTERRUPTED) {
+            printf("\nMaximum flow from %s to %s was not computed: the query %s\n",
+                   sourceUrl, sinkUrl, queryStatusName(limits.status));
         } else {
             printf("Error: Could not compute maximum flow. Check if URLs exist in the graph.\n");
         }
@@ -74,8 +165,8 @@ int main() {
         printf("\nBroken Links:\n");
         int brokenCount = 0;
         for (int i = 0; i < graph->numVertices; i++) {
-            if (graph->nodes[i].numEdges == 0 && graph->nodes[i].url != NULL) {
-                printf("%s\n", graph->nodes[i].url);
+            if (graph->nodes[i].numEdges == 0 && hasVertexUrl(graph, i)) {
+                printf("%s\n", getVertexUrl(graph, i, urlBuf));
                 brokenCount++;
             }
         }
@@ -83,12 +174,21 @@ int main() {
             printf("No broken links found\n");
         }
         
-        writeGraphToDot(graph, "graph.dot");
-        printf("Graph has been written to graph.dot\n");
+        // With --dot-hops only the minimum cut and its surroundings are
+        // exported, which keeps the file readable on large graphs
+        if (dotHops >= 0 && maxFlow >= 0) {
+            writeCutNeighbourhoodToDot(graph, sources, numSources, dotHops, "graph.dot");
+            printf("Minimum cut (%d hops) has been written to graph.dot\n", dotHops);
+        } else {
+            writeGraphToDot(graph, "graph.dot");
+            printf("Graph has been written to graph.dot\n");
+        }
     } else {
         printf("No vertices were loaded from the file\n");
     }
     
+    if (options.report) freeFlowReport(options.report);
+    printMemoryStats(&graph->memory);
     freeGraph(graph);
     return 0;
 }
\ No newline at end of file
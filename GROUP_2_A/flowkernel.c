@@ -0,0 +1,158 @@
+#include "flowkernel.h"
+
+#define FLOW_CAP uint8_t
+#define FLOW_NAME(x) x##8
+#include "flowkernelimpl.h"
+#undef FLOW_CAP
+#undef FLOW_NAME
+
+#define FLOW_CAP uint16_t
+#define FLOW_NAME(x) x##16
+#include "flowkernelimpl.h"
+#undef FLOW_CAP
+#undef FLOW_NAME
+
+#define FLOW_CAP uint32_t
+#define FLOW_NAME(x) x##32
+#include "flowkernelimpl.h"
+#undef FLOW_CAP
+#undef FLOW_NAME
+
+static const size_t capacityBytes[] = {1, 2, 4};
+
+static int findArc(const FlowNetwork* net, int u, int v) {
+    int lo = net->offsets[u], hi = net->offsets[u + 1] - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (net->arcDest[mid] == v) return mid;
+        if (net->arcDest[mid] < v) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return -1;
+}
+
+// Builds the residual network from (src, dest, capacity) triples. A zero
+// capacity reverse arc is added for every triple, so arcs appear in both
+// directions even when only one direction is a link; the builder is
+// extended in place for that.
+FlowNetwork* createFlowNetwork(int numVertices, EdgeBuilder* arcs) {
+    int numTriples = arcs->numEdges;
+    for (int i = 0; i < numTriples; i++) {
+        if (!edgeBuilderAdd(arcs, arcs->dest[i], arcs->src[i], 0)) return NULL;
+    }
+    EdgeList* list = buildEdgeList(arcs, numVertices, DUPLICATE_MAX, 0);
+    if (!list) return NULL;
+
+    FlowNetwork* net = (FlowNetwork*)calloc(1, sizeof(FlowNetwork));
+    if (!net) {
+        freeEdgeList(list);
+        return NULL;
+    }
+    int n = numVertices, m = list->numEdges;
+    net->numVertices = n;
+    net->numArcs = m;
+    net->offsets = list->outOffsets;
+    net->arcDest = list->outDest;
+    list->outOffsets = NULL;
+    list->outDest = NULL;
+    net->reverse = (int*)malloc((m + 1) * sizeof(int));
+    net->parent = (int*)malloc((n + 1) * sizeof(int));
+    net->parentArc = (int*)malloc((n + 1) * sizeof(int));
+    net->queue = (int*)malloc((n + 1) * sizeof(int));
+    net->visited = (char*)malloc(n + 1);
+    if (!net->reverse || !net->parent || !net->parentArc || !net->queue || !net->visited) {
+        freeEdgeList(list);
+        freeFlowNetwork(net);
+        return NULL;
+    }
+
+    unsigned long long widest = 0;
+    for (int u = 0; u < n; u++) {
+        for (int a = net->offsets[u]; a < net->offsets[u + 1]; a++) {
+            net->reverse[a] = findArc(net, net->arcDest[a], u);
+            unsigned long long pair =
+                (unsigned long long)(list->outWeight[a] > 0 ? list->outWeight[a] : 0) +
+                (unsigned long long)(list->outWeight[net->reverse[a]] > 0 ?
+                                     list->outWeight[net->reverse[a]] : 0);
+            if (pair > widest) widest = pair;
+        }
+    }
+    net->width = widest <= UINT8_MAX ? CAPACITY_8 :
+                 widest <= UINT16_MAX ? CAPACITY_16 : CAPACITY_32;
+
+    net->residual = malloc((m + 1) * capacityBytes[net->width]);
+    if (!net->residual) {
+        freeEdgeList(list);
+        freeFlowNetwork(net);
+        return NULL;
+    }
+    switch (net->width) {
+        case CAPACITY_8: fill8(net, list->outWeight); break;
+        case CAPACITY_16: fill16(net, list->outWeight); break;
+        case CAPACITY_32: fill32(net, list->outWeight); break;
+    }
+
+    freeEdgeList(list);
+    return net;
+}
+
+int flowNetworkBfs(FlowNetwork* net, const int* sources, int numSources,
+                   const char* isSink, unsigned long long delta) {
+    switch (net->width) {
+        case CAPACITY_8: return bfs8(net, sources, numSources, isSink, delta);
+        case CAPACITY_16: return bfs16(net, sources, numSources, isSink, delta);
+        case CAPACITY_32: return bfs32(net, sources, numSources, isSink, delta);
+    }
+    return -1;
+}
+
+unsigned long long flowNetworkAugment(FlowNetwork* net, int sink) {
+    switch (net->width) {
+        case CAPACITY_8: return augment8(net, sink);
+        case CAPACITY_16: return augment16(net, sink);
+        case CAPACITY_32: return augment32(net, sink);
+    }
+    return 0;
+}
+
+unsigned long long flowNetworkResidual(const FlowNetwork* net, int arc) {
+    switch (net->width) {
+        case CAPACITY_8: return ((const uint8_t*)net->residual)[arc];
+        case CAPACITY_16: return ((const uint16_t*)net->residual)[arc];
+        case CAPACITY_32: return ((const uint32_t*)net->residual)[arc];
+    }
+    return 0;
+}
+
+// Upper bound for a network built from numTriples triples: each gives at
+// most two arcs and no capacity needs more than 32 bits
+size_t flowNetworkResidualBytes(int numVertices, int numTriples) {
+    return sizeof(FlowNetwork) + (size_t)(numVertices + 1) * sizeof(int) +
+           (size_t)numTriples * 2 * (2 * sizeof(int) + capacityBytes[CAPACITY_32]);
+}
+
+size_t flowNetworkSearchBytes(int numVertices) {
+    return (size_t)(numVertices + 1) * (3 * sizeof(int) + 1);
+}
+
+const char* capacityWidthName(CapacityWidth width) {
+    switch (width) {
+        case CAPACITY_8: return "8-bit";
+        case CAPACITY_16: return "16-bit";
+        case CAPACITY_32: return "32-bit";
+    }
+    return "?";
+}
+
+void freeFlowNetwork(FlowNetwork* net) {
+    if (!net) return;
+    free(net->offsets);
+    free(net->arcDest);
+    free(net->reverse);
+    free(net->residual);
+    free(net->parent);
+    free(net->parentArc);
+    free(net->queue);
+    free(net->visited);
+    free(net);
+}
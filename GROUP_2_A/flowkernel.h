@@ -0,0 +1,49 @@
+#ifndef FLOWKERNEL_H
+#define FLOWKERNEL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "edgebuilder.h"
+
+// Storage type of the residual capacities. The narrowest type that can
+// hold c(u,v) + c(v,u) for every arc pair is picked when the network is
+// built, since no residual can ever exceed that sum. Capacities are ints,
+// so the sum always fits in 32 unsigned bits.
+typedef enum CapacityWidth {
+    CAPACITY_8,
+    CAPACITY_16,
+    CAPACITY_32
+} CapacityWidth;
+
+// Residual network in arc form: every vertex lists its out- and in-
+// neighbours sorted by id, reverse[a] is the opposite arc of a, and
+// residual points at numArcs values of the chosen width
+typedef struct FlowNetwork {
+    int numVertices;
+    int numArcs;
+    CapacityWidth width;
+    int* offsets;
+    int* arcDest;
+    int* reverse;
+    void* residual;
+    int* parent;
+    int* parentArc;
+    int* queue;
+    char* visited;
+    int lastSettled;        // vertices the last search took off its queue
+    long lastScanned;       // arcs it looked at
+} FlowNetwork;
+
+FlowNetwork* createFlowNetwork(int numVertices, EdgeBuilder* arcs);
+int flowNetworkBfs(FlowNetwork* net, const int* sources, int numSources,
+                   const char* isSink, unsigned long long delta);
+unsigned long long flowNetworkAugment(FlowNetwork* net, int sink);
+unsigned long long flowNetworkResidual(const FlowNetwork* net, int arc);
+size_t flowNetworkResidualBytes(int numVertices, int numTriples);
+size_t flowNetworkSearchBytes(int numVertices);
+const char* capacityWidthName(CapacityWidth width);
+void freeFlowNetwork(FlowNetwork* net);
+
+#endif
@@ -0,0 +1,71 @@
+// Hot loops of the flow kernel for a single capacity type. flowkernel.c
+// includes this once per width with FLOW_CAP set to the storage type and
+// FLOW_NAME(x) giving each instance its own function names, so the
+// residual comparisons compile down to loads of exactly that width.
+
+// Breadth-first search over arcs with at least delta residual capacity.
+// Returns the first sink reached, or -1. The work done is left in
+// lastSettled and lastScanned.
+static int FLOW_NAME(bfs)(FlowNetwork* net, const int* sources, int numSources,
+                          const char* isSink, unsigned long long delta) {
+    const FLOW_CAP* residual = (const FLOW_CAP*)net->residual;
+    int front = 0, rear = 0;
+    long scanned = 0;
+
+    memset(net->visited, 0, net->numVertices);
+    for (int i = 0; i < numSources; i++) {
+        int s = sources[i];
+        if (net->visited[s]) continue;
+        net->visited[s] = 1;
+        net->parent[s] = -1;
+        net->parentArc[s] = -1;
+        net->queue[rear++] = s;
+    }
+
+    while (front < rear) {
+        int u = net->queue[front++];
+        scanned += net->offsets[u + 1] - net->offsets[u];
+        for (int a = net->offsets[u]; a < net->offsets[u + 1]; a++) {
+            int v = net->arcDest[a];
+            if (net->visited[v] || residual[a] < delta) continue;
+            net->visited[v] = 1;
+            net->parent[v] = u;
+            net->parentArc[v] = a;
+            if (isSink[v]) {
+                net->lastSettled = front;
+                net->lastScanned = scanned;
+                return v;
+            }
+            net->queue[rear++] = v;
+        }
+    }
+    net->lastSettled = front;
+    net->lastScanned = scanned;
+    return -1;
+}
+
+// Pushes the bottleneck amount along the path found by the last search
+static unsigned long long FLOW_NAME(augment)(FlowNetwork* net, int sink) {
+    FLOW_CAP* residual = (FLOW_CAP*)net->residual;
+    FLOW_CAP bottleneck = 0;
+    int first = 1;
+
+    for (int v = sink; net->parentArc[v] != -1; v = net->parent[v]) {
+        int a = net->parentArc[v];
+        if (first || residual[a] < bottleneck) bottleneck = residual[a];
+        first = 0;
+    }
+    for (int v = sink; net->parentArc[v] != -1; v = net->parent[v]) {
+        int a = net->parentArc[v];
+        residual[a] -= bottleneck;
+        residual[net->reverse[a]] += bottleneck;
+    }
+    return (unsigned long long)bottleneck;
+}
+
+static void FLOW_NAME(fill)(FlowNetwork* net, const int* capacities) {
+    FLOW_CAP* residual = (FLOW_CAP*)net->residual;
+    for (int a = 0; a < net->numArcs; a++) {
+        residual[a] = (FLOW_CAP)(capacities[a] > 0 ? capacities[a] : 0);
+    }
+}
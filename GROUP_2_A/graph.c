@@ -0,0 +1,1388 @@
+#include "graph.h"
+
+static void initGraphFields(Graph* graph, int vertices, size_t budget) {
+    initMemAccount(&graph->memory, budget);
+    graph->nodes = NULL;
+    graph->adjMatrix = NULL;
+    graph->numVertices = vertices;
+    graph->duplicatePolicy = DUPLICATE_LAST;
+    graph->originalId = NULL;
+    graph->urlDict = NULL;
+    graph->urlRank = NULL;
+    graph->rankVertex = NULL;
+    graph->outAdj = NULL;
+    graph->inAdj = NULL;
+    graph->reachIndex = NULL;
+    graph->edgeIndex = NULL;
+    graph->unsortedEdges = NULL;
+    graph->pendingUpdates = 0;
+    graph->wantCompressed = 0;
+    graph->wantReachIndex = 0;
+    pthread_rwlock_init(&graph->lock, NULL);
+    graph->version = 0;
+    graph->pathCache = NULL;
+    graph->disk = NULL;
+}
+
+Graph* createGraph(int vertices) {
+    return createGraphWithBudget(vertices, 0);
+}
+
+// The node array and matrix are the largest fixed cost, so they are
+// checked against the budget (0 = unlimited) before anything is allocated
+Graph* createGraphWithBudget(int vertices, size_t budget) {
+    size_t fixedBytes = (size_t)vertices *
+        (sizeof(Node) + sizeof(int*) + (size_t)vertices * sizeof(int));
+    if (budget && fixedBytes > budget) {
+        printf("Error: A %d vertex graph needs %zu bytes, over the %zu byte memory budget\n",
+               vertices, fixedBytes, budget);
+        return NULL;
+    }
+
+    Graph* graph = (Graph*)malloc(sizeof(Graph));
+    initGraphFields(graph, vertices, budget);
+    memReserve(&graph->memory, MEM_ADJACENCY, fixedBytes);
+    graph->nodes = (Node*)malloc(vertices * sizeof(Node));
+
+    graph->adjMatrix = (int**)malloc(vertices * sizeof(int*));
+    for (int i = 0; i < vertices; i++) {
+        graph->adjMatrix[i] = (int*)calloc(vertices, sizeof(int));
+        graph->nodes[i].vertex = i;
+        graph->nodes[i].url = NULL;
+        graph->nodes[i].edges = NULL;
+        graph->nodes[i].numEdges = 0;
+        graph->nodes[i].edgeCapacity = 0;
+    }
+
+    return graph;
+}
+
+// Opens an adjacency file written by buildDiskGraph. Only the vertex index,
+// the URLs and the block cache are held in memory, so the graph can be far
+// larger than RAM; searches page neighbour lists in as they reach them.
+Graph* openDiskResidentGraph(const char* filename, size_t cacheBytes, size_t budget) {
+    DiskGraph* disk = openDiskGraph(filename, cacheBytes, budget);
+    if (!disk) return NULL;
+    Graph* graph = (Graph*)malloc(sizeof(Graph));
+    if (!graph) {
+        closeDiskGraph(disk);
+        return NULL;
+    }
+    initGraphFields(graph, disk->numVertices, budget);
+
+    // The graph takes over the URL dictionary so lookups work unchanged
+    graph->disk = disk;
+    graph->urlDict = disk->urlDict;
+    graph->urlRank = disk->urlRank;
+    graph->rankVertex = disk->rankVertex;
+    disk->urlDict = NULL;
+    disk->urlRank = NULL;
+    disk->rankVertex = NULL;
+    size_t urlBytes = urlDictBytes(graph->urlDict) +
+                      (size_t)(graph->numVertices + graph->urlDict->numUrls) * sizeof(int);
+    if (!memReserve(&graph->memory, MEM_URLS, urlBytes) ||
+        !memReserve(&graph->memory, MEM_ADJACENCY, diskGraphBytes(disk))) {
+        printf("Error: The index and cache of '%s' need %zu bytes, over the memory budget\n",
+               filename, urlBytes + diskGraphBytes(disk));
+        freeGraph(graph);
+        return NULL;
+    }
+    printf("Opened '%s': %d vertices, %lld edges on disk, %d block cache\n",
+           filename, disk->numVertices, disk->numEdges, disk->numBlocks);
+    return graph;
+}
+
+void dropReachIndex(Graph* graph) {
+    if (graph->reachIndex) {
+        memRelease(&graph->memory, MEM_ADJACENCY, reachIndexBytes(graph->reachIndex));
+    }
+    freeReachIndex(graph->reachIndex);
+    graph->reachIndex = NULL;
+}
+
+static void dropCompressedAdjacency(Graph* graph) {
+    if (graph->outAdj) {
+        memRelease(&graph->memory, MEM_ADJACENCY,
+                   adjBytes(graph->outAdj) + adjBytes(graph->inAdj));
+    }
+    freeCompressedAdjacency(graph->outAdj);
+    freeCompressedAdjacency(graph->inAdj);
+    graph->outAdj = NULL;
+    graph->inAdj = NULL;
+}
+
+static void dropEdgeIndex(Graph* graph) {
+    if (graph->edgeIndex) {
+        memRelease(&graph->memory, MEM_ADJACENCY,
+                   edgeIndexBytes(graph->edgeIndex) + graph->numVertices);
+    }
+    freeEdgeIndex(graph->edgeIndex);
+    free(graph->unsortedEdges);
+    graph->edgeIndex = NULL;
+    graph->unsortedEdges = NULL;
+}
+
+// Frees the Edge arrays once outAdj holds the same edges; degrees stay
+static void releaseEdgeArrays(Graph* graph) {
+    for (int u = 0; u < graph->numVertices; u++) {
+        Node* node = &graph->nodes[u];
+        memRelease(&graph->memory, MEM_ADJACENCY, (size_t)node->edgeCapacity * sizeof(Edge));
+        free(node->edges);
+        node->edges = NULL;
+        node->edgeCapacity = 0;
+    }
+}
+
+// Decodes the compressed lists back into Edge arrays so that updates and
+// reordering can work on them in place. Returns 0 if there is no memory.
+static int restoreEdgeLists(Graph* graph) {
+    if (!graph->outAdj) return 1;
+    for (int u = 0; u < graph->numVertices; u++) {
+        Node* node = &graph->nodes[u];
+        if (node->numEdges == 0) continue;
+        size_t bytes = (size_t)node->numEdges * sizeof(Edge);
+        int reserved = memReserve(&graph->memory, MEM_ADJACENCY, bytes);
+        node->edges = reserved ? (Edge*)malloc(bytes) : NULL;
+        if (!node->edges) {
+            if (reserved) memRelease(&graph->memory, MEM_ADJACENCY, bytes);
+            printf("Error: Not enough memory or budget to expand the compressed edges\n");
+            releaseEdgeArrays(graph);
+            return 0;
+        }
+        node->edgeCapacity = node->numEdges;
+
+        AdjIterator it;
+        int count = 0;
+        adjBegin(graph->outAdj, u, &it);
+        while (count < node->numEdges &&
+               adjNext(&it, &node->edges[count].dest, &node->edges[count].weight)) {
+            count++;
+        }
+    }
+    dropCompressedAdjacency(graph);
+    return 1;
+}
+
+// Re-adding an existing link replaces its weight instead of duplicating it
+void addEdge(Graph* graph, int src, int dest, int weight) {
+    EdgeUpdate update = {EDGE_INSERT, src, dest, weight};
+    applyEdgeUpdates(graph, &update, 1);
+}
+
+// Replaces the adjacency of every vertex covered by the list with its
+// merged, dest-sorted edges, one exactly sized allocation per vertex
+void loadGraphFromEdgeList(Graph* graph, EdgeList* list) {
+    if (list->numVertices > graph->numVertices) {
+        printf("Error: Edge list has %d vertices but graph only holds %d\n",
+               list->numVertices, graph->numVertices);
+        return;
+    }
+    if (!restoreEdgeLists(graph)) return;
+    if (graph->reachIndex) dropReachIndex(graph);
+    if (graph->edgeIndex) dropEdgeIndex(graph);
+    graph->version++;
+
+    size_t oldBytes = 0;
+    for (int u = 0; u < list->numVertices; u++) {
+        oldBytes += (size_t)graph->nodes[u].edgeCapacity * sizeof(Edge);
+    }
+    memRelease(&graph->memory, MEM_ADJACENCY, oldBytes);
+    if (!memReserve(&graph->memory, MEM_ADJACENCY, (size_t)list->numEdges * sizeof(Edge))) {
+        memReserve(&graph->memory, MEM_ADJACENCY, oldBytes);
+        printf("Error: Loading %d edges would exceed the memory budget\n", list->numEdges);
+        return;
+    }
+
+    for (int u = 0; u < list->numVertices; u++) {
+        Node* node = &graph->nodes[u];
+        for (int j = 0; j < node->numEdges; j++) {
+            graph->adjMatrix[u][node->edges[j].dest] = 0;
+        }
+        free(node->edges);
+        node->edges = NULL;
+
+        int begin = list->outOffsets[u];
+        int count = list->outOffsets[u + 1] - begin;
+        node->numEdges = count;
+        node->edgeCapacity = count;
+        if (count == 0) continue;
+
+        node->edges = (Edge*)malloc(count * sizeof(Edge));
+        for (int j = 0; j < count; j++) {
+            node->edges[j].dest = list->outDest[begin + j];
+            node->edges[j].weight = list->outWeight[begin + j];
+            graph->adjMatrix[u][node->edges[j].dest] = node->edges[j].weight;
+        }
+    }
+}
+
+static int compareEdgeDest(const void* a, const void* b) {
+    return ((const Edge*)a)->dest - ((const Edge*)b)->dest;
+}
+
+// Relabels the loaded vertices so that neighbours sit close together in
+// memory. URLs, edge lists and matrix rows/columns move with their vertex;
+// originalId[new] keeps the first-seen id, which reports show through
+// originalVertexId.
+static void relabelVertices(Graph* graph, VertexOrder order) {
+    if (graph->reachIndex) dropReachIndex(graph);
+    if (graph->edgeIndex) dropEdgeIndex(graph);
+
+    int n = 0;
+    while (n < graph->numVertices && hasVertexUrl(graph, n)) n++;
+    if (n == 0) return;
+
+    EdgeBuilder* builder = createEdgeBuilder(n);
+    if (!builder) {
+        printf("Error: Not enough memory to reorder graph\n");
+        return;
+    }
+    for (int u = 0; u < n; u++) {
+        for (int j = 0; j < graph->nodes[u].numEdges; j++) {
+            if (!edgeBuilderAdd(builder, u, graph->nodes[u].edges[j].dest,
+                                graph->nodes[u].edges[j].weight)) {
+                printf("Error: Not enough memory to reorder graph\n");
+                freeEdgeBuilder(builder);
+                return;
+            }
+        }
+    }
+    EdgeList* list = buildEdgeList(builder, n, DUPLICATE_LAST, 0);
+    freeEdgeBuilder(builder);
+    if (!list) {
+        printf("Error: Not enough memory to reorder graph\n");
+        return;
+    }
+
+    int* newId = computeVertexOrder(list, order);
+    freeEdgeList(list);
+    Node* nodes = (Node*)malloc(n * sizeof(Node));
+    int** rows = (int**)malloc(n * sizeof(int*));
+    int* scratch = (int*)malloc(graph->numVertices * sizeof(int));
+    size_t idBytes = graph->numVertices * sizeof(int);
+    if (!graph->originalId && memReserve(&graph->memory, MEM_ADJACENCY, idBytes)) {
+        graph->originalId = (int*)malloc(idBytes);
+        if (graph->originalId) {
+            for (int v = 0; v < graph->numVertices; v++) graph->originalId[v] = v;
+        } else {
+            memRelease(&graph->memory, MEM_ADJACENCY, idBytes);
+        }
+    }
+    if (!newId || !nodes || !rows || !scratch || !graph->originalId) {
+        printf("Error: Not enough memory to reorder graph\n");
+        free(newId);
+        free(nodes);
+        free(rows);
+        free(scratch);
+        return;
+    }
+
+    //mean |u - v| over the edges, a rough proxy for how far apart in
+    //memory a traversal has to jump
+    long long spanBefore = 0, spanAfter = 0, numEdges = 0;
+    for (int v = 0; v < n; v++) {
+        Node node = graph->nodes[v];
+        node.vertex = newId[v];
+        for (int j = 0; j < node.numEdges; j++) {
+            int dest = node.edges[j].dest;
+            spanBefore += abs(v - dest);
+            spanAfter += abs(newId[v] - newId[dest]);
+            node.edges[j].dest = newId[dest];
+        }
+        numEdges += node.numEdges;
+        if (node.numEdges > 1) {
+            qsort(node.edges, node.numEdges, sizeof(Edge), compareEdgeDest);
+        }
+        nodes[newId[v]] = node;
+        rows[newId[v]] = graph->adjMatrix[v];
+        scratch[newId[v]] = graph->originalId[v];
+    }
+    memcpy(graph->nodes, nodes, n * sizeof(Node));
+    memcpy(graph->adjMatrix, rows, n * sizeof(int*));
+    memcpy(graph->originalId, scratch, n * sizeof(int));
+    if (graph->urlDict) {
+        for (int v = 0; v < n; v++) scratch[newId[v]] = graph->urlRank[v];
+        memcpy(graph->urlRank, scratch, n * sizeof(int));
+        for (int v = 0; v < n; v++) graph->rankVertex[graph->urlRank[v]] = v;
+    }
+
+    //permute columns; vertices past n have no edges so those stay zero
+    for (int u = 0; u < n; u++) {
+        int* row = graph->adjMatrix[u];
+        for (int v = 0; v < n; v++) scratch[newId[v]] = row[v];
+        memcpy(row, scratch, n * sizeof(int));
+    }
+
+    graph->version++;
+    printf("Reordered %d vertices, mean edge span %.1f -> %.1f\n", n,
+           numEdges ? (double)spanBefore / numEdges : 0.0,
+           numEdges ? (double)spanAfter / numEdges : 0.0);
+    free(newId);
+    free(nodes);
+    free(rows);
+    free(scratch);
+}
+
+// A compressed graph is expanded for the move and compressed again after
+void reorderGraph(Graph* graph, VertexOrder order) {
+    if (order == ORDER_NONE || graph->disk) return;
+    if (!restoreEdgeLists(graph)) return;
+    relabelVertices(graph, order);
+    if (graph->wantCompressed) compressGraph(graph);
+}
+
+// Packs the current edges into gap/varint encoded forward and reverse
+// lists and frees the Edge arrays they replace. Every reader goes through
+// outEdgesBegin or the BFS kernels, so only updates and reordering expand
+// the lists again; they compress them once they are done.
+void compressGraph(Graph* graph) {
+    if (graph->disk || graph->outAdj) return;
+    graph->wantCompressed = 1;
+
+    //trailing vertices with no URL and no edges are left out
+    int n = 0;
+    for (int u = 0; u < graph->numVertices; u++) {
+        if (hasVertexUrl(graph, u) || graph->nodes[u].numEdges > 0) n = u + 1;
+        for (int j = 0; j < graph->nodes[u].numEdges; j++) {
+            if (graph->nodes[u].edges[j].dest >= n) n = graph->nodes[u].edges[j].dest + 1;
+        }
+    }
+
+    EdgeBuilder* builder = createEdgeBuilder(n);
+    if (!builder) {
+        printf("Error: Not enough memory to compress adjacency\n");
+        return;
+    }
+    for (int u = 0; u < n; u++) {
+        for (int j = 0; j < graph->nodes[u].numEdges; j++) {
+            if (!edgeBuilderAdd(builder, u, graph->nodes[u].edges[j].dest,
+                                graph->nodes[u].edges[j].weight)) {
+                printf("Error: Not enough memory to compress adjacency\n");
+                freeEdgeBuilder(builder);
+                return;
+            }
+        }
+    }
+    EdgeList* list = buildEdgeList(builder, n, DUPLICATE_LAST, 0);
+    freeEdgeBuilder(builder);
+    if (!list) {
+        printf("Error: Not enough memory to compress adjacency\n");
+        return;
+    }
+
+    // Varints take at most 5 bytes, so this bounds both directions; the
+    // plain edge lists stay in use if it does not fit
+    size_t worstCase = 2 * ((size_t)(n + 1) * 4 * sizeof(size_t) + (size_t)list->numEdges * 10);
+    if (worstCase > memAvailable(&graph->memory)) {
+        printf("Skipping adjacency compression: it could exceed the memory budget\n");
+        freeEdgeList(list);
+        return;
+    }
+
+    graph->outAdj = compressAdjacency(list->numVertices, list->outOffsets,
+                                      list->outDest, list->outWeight);
+    graph->inAdj = compressAdjacency(list->numVertices, list->inOffsets,
+                                     list->inSrc, list->inWeight);
+    if (!graph->outAdj || !graph->inAdj) {
+        printf("Error: Not enough memory to compress adjacency\n");
+        dropCompressedAdjacency(graph);
+    } else {
+        size_t edgeBytes = 0;
+        for (int u = 0; u < graph->numVertices; u++) {
+            edgeBytes += (size_t)graph->nodes[u].edgeCapacity * sizeof(Edge);
+        }
+        memReserve(&graph->memory, MEM_ADJACENCY,
+                   adjBytes(graph->outAdj) + adjBytes(graph->inAdj));
+        // The edge index points into the arrays being freed
+        if (graph->edgeIndex) dropEdgeIndex(graph);
+        releaseEdgeArrays(graph);
+        printf("Compressed %d edges into %zu bytes forward + %zu bytes reverse "
+               "(freed %zu bytes of Edge lists)\n",
+               list->numEdges, adjBytes(graph->outAdj), adjBytes(graph->inAdj), edgeBytes);
+    }
+    freeEdgeList(list);
+}
+
+// Computes strongly connected components over the edges a search can
+// follow, so that impossible queries are answered without a traversal
+void buildReachability(Graph* graph) {
+    if (graph->disk) return;
+    dropReachIndex(graph);
+    graph->wantReachIndex = 1;
+
+    //trailing vertices with no URL and no edges are left out
+    int n = 0, numEdges = 0;
+    for (int u = 0; u < graph->numVertices; u++) {
+        if (hasVertexUrl(graph, u) || graph->nodes[u].numEdges > 0) n = u + 1;
+        EdgeCursor cursor;
+        int v, weight;
+        outEdgesBegin(graph, u, &cursor);
+        while (outEdgesNext(&cursor, &v, &weight)) {
+            if (v >= n) n = v + 1;
+        }
+        numEdges += graph->nodes[u].numEdges;
+    }
+    int* offsets = (int*)malloc((n + 1) * sizeof(int));
+    int* dests = (int*)malloc((numEdges + 1) * sizeof(int));
+    if (!offsets || !dests) {
+        free(offsets);
+        free(dests);
+        return;
+    }
+
+    offsets[0] = 0;
+    for (int u = 0; u < n; u++) {
+        offsets[u + 1] = offsets[u];
+        EdgeCursor cursor;
+        int v, weight;
+        outEdgesBegin(graph, u, &cursor);
+        while (outEdgesNext(&cursor, &v, &weight)) {
+            if (weight != 0) dests[offsets[u + 1]++] = v;
+        }
+    }
+    // Without room for the bitsets the index keeps only its level filters
+    size_t baseBytes = sizeof(ReachIndex) + 3 * (size_t)(n + 1) * sizeof(int);
+    size_t available = memAvailable(&graph->memory);
+    if (baseBytes > available) {
+        printf("Skipping reachability index: it would exceed the memory budget\n");
+        free(offsets);
+        free(dests);
+        return;
+    }
+    size_t bitsetBytes = available - baseBytes;
+    if (bitsetBytes > REACH_BITSET_MAX_BYTES) bitsetBytes = REACH_BITSET_MAX_BYTES;
+    graph->reachIndex = buildReachIndex(n, offsets, dests, bitsetBytes);
+    free(offsets);
+    free(dests);
+    if (graph->reachIndex) {
+        memReserve(&graph->memory, MEM_ADJACENCY, reachIndexBytes(graph->reachIndex));
+    }
+
+    if (!graph->reachIndex) {
+        printf("Error: Not enough memory to build the reachability index\n");
+    } else {
+        printf("Reachability index: %d strongly connected components, largest has %d vertices (%zu bytes)\n",
+               graph->reachIndex->numComponents, graph->reachIndex->largestComponent,
+               reachIndexBytes(graph->reachIndex));
+    }
+}
+
+static int ensureEdgeIndex(Graph* graph) {
+    if (graph->edgeIndex) return 1;
+
+    int numEdges = 0;
+    for (int u = 0; u < graph->numVertices; u++) numEdges += graph->nodes[u].numEdges;
+    EdgeIndex sizing = {NULL, NULL, 16, 0};
+    while (sizing.capacity < numEdges * 2) sizing.capacity *= 2;
+    if (!memReserve(&graph->memory, MEM_ADJACENCY,
+                    edgeIndexBytes(&sizing) + graph->numVertices)) {
+        printf("Error: Indexing %d edges for updates would exceed the memory budget\n", numEdges);
+        return 0;
+    }
+    graph->edgeIndex = createEdgeIndex(numEdges);
+    graph->unsortedEdges = (char*)calloc(graph->numVertices, sizeof(char));
+    if (!graph->edgeIndex || !graph->unsortedEdges) {
+        dropEdgeIndex(graph);
+        return 0;
+    }
+    for (int u = 0; u < graph->numVertices; u++) {
+        for (int j = 0; j < graph->nodes[u].numEdges; j++) {
+            if (!edgeIndexPut(graph->edgeIndex, u, graph->nodes[u].edges[j].dest, j)) {
+                dropEdgeIndex(graph);
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+// Applies a single update to the edge array, the matrix and the edge index
+// in O(1) amortised; deletions swap the last edge into the hole. Returns 1
+// when the graph changed, 0 when the update did not apply and -1 when it
+// could not get the memory. The caller holds the write lock.
+static int applyUpdate(Graph* graph, const EdgeUpdate* update) {
+    int src = update->src, dest = update->dest;
+    if (src < 0 || dest < 0 || src >= graph->numVertices || dest >= graph->numVertices) {
+        return 0;
+    }
+
+    Node* node = &graph->nodes[src];
+    int slot = edgeIndexFind(graph->edgeIndex, src, dest);
+    int wasTraversable = graph->adjMatrix[src][dest] != 0;
+
+    if (update->type == EDGE_DELETE) {
+        if (slot == -1) return 0;
+        int last = --node->numEdges;
+        edgeIndexRemove(graph->edgeIndex, src, dest);
+        if (slot != last) {
+            node->edges[slot] = node->edges[last];
+            edgeIndexPut(graph->edgeIndex, src, node->edges[slot].dest, slot);
+            graph->unsortedEdges[src] = 1;
+        }
+        graph->adjMatrix[src][dest] = 0;
+    } else {
+        if (slot == -1) {
+            if (update->type == EDGE_SET_WEIGHT) return 0;
+            if (node->numEdges == node->edgeCapacity) {
+                int capacity = node->edgeCapacity < 4 ? 4 : node->edgeCapacity * 2;
+                size_t extra = (size_t)(capacity - node->edgeCapacity) * sizeof(Edge);
+                if (!memReserve(&graph->memory, MEM_ADJACENCY, extra)) return -1;
+                Edge* edges = (Edge*)realloc(node->edges, capacity * sizeof(Edge));
+                if (!edges) {
+                    memRelease(&graph->memory, MEM_ADJACENCY, extra);
+                    return -1;
+                }
+                node->edges = edges;
+                node->edgeCapacity = capacity;
+            }
+            size_t growth = edgeIndexGrowthBytes(graph->edgeIndex);
+            if (!memReserve(&graph->memory, MEM_ADJACENCY, growth)) return -1;
+            if (!edgeIndexPut(graph->edgeIndex, src, dest, node->numEdges)) {
+                memRelease(&graph->memory, MEM_ADJACENCY, growth);
+                return -1;
+            }
+            slot = node->numEdges++;
+            node->edges[slot].dest = dest;
+            if (slot > 0 && node->edges[slot - 1].dest > dest) graph->unsortedEdges[src] = 1;
+        }
+        node->edges[slot].weight = update->weight;
+        graph->adjMatrix[src][dest] = update->weight;
+    }
+
+    // Removing reachability leaves the SCC index a valid over-estimate;
+    // only a newly traversable edge can make it wrong
+    if (graph->outAdj) dropCompressedAdjacency(graph);
+    if (graph->reachIndex && !wasTraversable && graph->adjMatrix[src][dest] != 0) {
+        dropReachIndex(graph);
+    }
+    return 1;
+}
+
+// Restores dest order in edge lists touched by updates, trims spare
+// capacity and rebuilds the traversal structures that were enabled, so the
+// layout matches a fresh load again
+static void compactEdgeLists(Graph* graph) {
+    int touched = 0;
+    for (int u = 0; u < graph->numVertices; u++) {
+        Node* node = &graph->nodes[u];
+        if (graph->unsortedEdges && graph->unsortedEdges[u]) {
+            qsort(node->edges, node->numEdges, sizeof(Edge), compareEdgeDest);
+            for (int j = 0; j < node->numEdges; j++) {
+                edgeIndexPut(graph->edgeIndex, u, node->edges[j].dest, j);
+            }
+            graph->unsortedEdges[u] = 0;
+            touched++;
+        }
+        if (node->edgeCapacity > node->numEdges) {
+            Edge* edges = node->numEdges ?
+                (Edge*)realloc(node->edges, node->numEdges * sizeof(Edge)) : NULL;
+            if (node->numEdges == 0) free(node->edges);
+            if (edges || node->numEdges == 0) {
+                memRelease(&graph->memory, MEM_ADJACENCY,
+                           (size_t)(node->edgeCapacity - node->numEdges) * sizeof(Edge));
+                node->edges = edges;
+                node->edgeCapacity = node->numEdges;
+            }
+        }
+    }
+    printf("Compacted edge lists after %d updates (%d vertices re-sorted)\n",
+           graph->pendingUpdates, touched);
+    graph->pendingUpdates = 0;
+
+    if (graph->wantCompressed && !graph->outAdj) compressGraph(graph);
+    if (graph->wantReachIndex && !graph->reachIndex) buildReachability(graph);
+}
+
+static int applyUpdatesLocked(Graph* graph, const EdgeUpdate* updates, int count) {
+    if (!restoreEdgeLists(graph)) return 0;
+    if (!ensureEdgeIndex(graph)) {
+        printf("Error: Not enough memory to index edges for updates\n");
+        return 0;
+    }
+
+    int changed = 0;
+    for (int i = 0; i < count; i++) {
+        int result = applyUpdate(graph, &updates[i]);
+        if (result < 0) {
+            printf("Error: Stopped after %d of %d updates: out of memory or over the memory budget\n",
+                   i, count);
+            break;
+        }
+        changed += result;
+    }
+    if (changed > 0) graph->version++;
+
+    graph->pendingUpdates += changed;
+    if (graph->pendingUpdates >= EDGE_COMPACT_INTERVAL) compactEdgeLists(graph);
+    return changed;
+}
+
+// Applies a batch of inserts, deletions and weight changes in place. The
+// whole batch is applied under the write lock, so queries running on other
+// threads see the graph either before or after it, never half way.
+// Returns the number of updates that changed the graph.
+int applyEdgeUpdates(Graph* graph, const EdgeUpdate* updates, int count) {
+    if (graph->disk) {
+        printf("Error: A disk-resident graph cannot be updated\n");
+        return 0;
+    }
+    pthread_rwlock_wrlock(&graph->lock);
+    int changed = applyUpdatesLocked(graph, updates, count);
+    pthread_rwlock_unlock(&graph->lock);
+    return changed;
+}
+
+int removeEdge(Graph* graph, int src, int dest) {
+    EdgeUpdate update = {EDGE_DELETE, src, dest, 0};
+    return applyEdgeUpdates(graph, &update, 1);
+}
+
+int setEdgeWeight(Graph* graph, int src, int dest, int weight) {
+    EdgeUpdate update = {EDGE_SET_WEIGHT, src, dest, weight};
+    return applyEdgeUpdates(graph, &update, 1);
+}
+
+void compactGraph(Graph* graph) {
+    pthread_rwlock_wrlock(&graph->lock);
+    if (graph->edgeIndex) compactEdgeLists(graph);
+    pthread_rwlock_unlock(&graph->lock);
+}
+
+// First vertex after the given one with no URL and no edges, or -1
+static int findFreeVertex(Graph* graph, int after) {
+    for (int v = after + 1; v < graph->numVertices; v++) {
+        if (!hasVertexUrl(graph, v) && graph->nodes[v].numEdges == 0) return v;
+    }
+    return -1;
+}
+
+// Finds the vertices of both URLs. With create, missing URLs get the first
+// unused vertices, but only once both ends are known to fit, so a failure
+// never leaves half an edge's endpoints behind. Returns 0 if either end
+// has no vertex.
+static int resolveEndpoints(Graph* graph, const char* fromUrl, const char* toUrl,
+                            int create, int* src, int* dest) {
+    *src = findVertexByUrl(graph, fromUrl);
+    *dest = findVertexByUrl(graph, toUrl);
+    if (!create) return *src != -1 && *dest != -1;
+
+    int newSrc = *src == -1;
+    int newDest = *dest == -1 && strcmp(fromUrl, toUrl) != 0;
+    int srcSlot = newSrc ? findFreeVertex(graph, -1) : -1;
+    int destSlot = newDest ? findFreeVertex(graph, srcSlot) : -1;
+    if ((newSrc && srcSlot == -1) || (newDest && destSlot == -1)) {
+        printf("Error: Maximum number of vertices reached\n");
+        return 0;
+    }
+    size_t bytes = (newSrc ? strlen(fromUrl) + 1 : 0) + (newDest ? strlen(toUrl) + 1 : 0);
+    if (bytes && !memReserve(&graph->memory, MEM_URLS, bytes)) {
+        printf("Error: Storing URL '%s' would exceed the memory budget\n",
+               newSrc ? fromUrl : toUrl);
+        return 0;
+    }
+    char* srcCopy = newSrc ? strdup(fromUrl) : NULL;
+    char* destCopy = newDest ? strdup(toUrl) : NULL;
+    if ((newSrc && !srcCopy) || (newDest && !destCopy)) {
+        printf("Error: Not enough memory to store new URLs\n");
+        free(srcCopy);
+        free(destCopy);
+        memRelease(&graph->memory, MEM_URLS, bytes);
+        return 0;
+    }
+    if (newSrc) {
+        graph->nodes[srcSlot].url = srcCopy;
+        *src = srcSlot;
+        printf("Created new vertex for %s at index %d\n", fromUrl, originalVertexId(graph, srcSlot));
+    }
+    if (newDest) {
+        graph->nodes[destSlot].url = destCopy;
+        *dest = destSlot;
+        printf("Created new vertex for %s at index %d\n", toUrl, originalVertexId(graph, destSlot));
+    }
+    if (*dest == -1) *dest = *src;
+    return 1;
+}
+
+// One parsed line of an update file, its URLs not yet resolved
+typedef struct UpdateLine {
+    EdgeUpdateType type;
+    int weight;
+    char fromUrl[MAX_URL_LENGTH];
+    char toUrl[MAX_URL_LENGTH];
+} UpdateLine;
+
+// Reads up to UPDATE_BATCH_SIZE update lines. Returns how many, setting
+// eof once the file is done.
+static int readUpdateLines(FILE* file, UpdateLine* lines, int* numLines, int* eof) {
+    char line[MAX_URL_LENGTH * 2 + 50];
+    int count = 0;
+    while (count < UPDATE_BATCH_SIZE) {
+        if (!fgets(line, sizeof(line), file)) {
+            *eof = 1;
+            break;
+        }
+        line[strcspn(line, "\r\n")] = '\0';
+
+        char* op = strtok(line, ",");
+        char* fromUrl = strtok(NULL, ",");
+        char* toUrl = strtok(NULL, ",");
+        char* weightToken = strtok(NULL, ",");
+        if (!op || !fromUrl || !toUrl) continue;
+        (*numLines)++;
+
+        UpdateLine* parsed = &lines[count];
+        if (strcmp(op, "add") == 0 && weightToken) {
+            parsed->type = EDGE_INSERT;
+        } else if (strcmp(op, "set") == 0 && weightToken) {
+            parsed->type = EDGE_SET_WEIGHT;
+        } else if (strcmp(op, "remove") == 0) {
+            parsed->type = EDGE_DELETE;
+        } else {
+            printf("Warning: Unknown update '%s', skipping line\n", op);
+            continue;
+        }
+        parsed->weight = weightToken ? abs(atoi(weightToken)) : 0;
+        strncpy(parsed->fromUrl, fromUrl, MAX_URL_LENGTH - 1);
+        strncpy(parsed->toUrl, toUrl, MAX_URL_LENGTH - 1);
+        parsed->fromUrl[MAX_URL_LENGTH - 1] = '\0';
+        parsed->toUrl[MAX_URL_LENGTH - 1] = '\0';
+        count++;
+    }
+    return count;
+}
+
+// Streams a file of "add,from,to,weight", "set,from,to,weight" and
+// "remove,from,to" lines into the graph, UPDATE_BATCH_SIZE lines at a
+// time. Each batch is read and parsed first; the write lock is only held
+// to resolve its URLs and apply it. Compaction is left to the
+// EDGE_COMPACT_INTERVAL schedule or compactGraph.
+int processUpdateFile(Graph* graph, const char* filename) {
+    if (graph->disk) {
+        printf("Error: A disk-resident graph cannot be updated\n");
+        return -1;
+    }
+    FILE* file = fopen(filename, "r");
+    if (!file) {
+        printf("Error: Cannot open file '%s'\n", filename);
+        return -1;
+    }
+    UpdateLine* lines = (UpdateLine*)malloc(UPDATE_BATCH_SIZE * sizeof(UpdateLine));
+    if (!lines) {
+        printf("Error: Not enough memory to read updates\n");
+        fclose(file);
+        return -1;
+    }
+
+    EdgeUpdate batch[UPDATE_BATCH_SIZE];
+    int numLines = 0, applied = 0, eof = 0;
+
+    while (!eof) {
+        int numParsed = readUpdateLines(file, lines, &numLines, &eof);
+        if (numParsed == 0) continue;
+
+        int count = 0;
+        pthread_rwlock_wrlock(&graph->lock);
+        for (int i = 0; i < numParsed; i++) {
+            EdgeUpdate* update = &batch[count];
+            update->type = lines[i].type;
+            update->weight = lines[i].weight;
+            if (resolveEndpoints(graph, lines[i].fromUrl, lines[i].toUrl,
+                                 update->type == EDGE_INSERT, &update->src, &update->dest)) {
+                count++;
+            }
+        }
+        applied += applyUpdatesLocked(graph, batch, count);
+        pthread_rwlock_unlock(&graph->lock);
+    }
+
+    free(lines);
+    fclose(file);
+    printf("Applied %d of %d edge updates from '%s'\n", applied, numLines, filename);
+    return applied;
+}
+
+int findVertexByUrl(Graph* graph, const char* url) {
+    if (graph->urlDict) {
+        int rank = urlDictFind(graph->urlDict, url);
+        if (rank != -1) return graph->rankVertex[rank];
+    }
+    if (!graph->nodes) return -1;
+    for (int i = 0; i < graph->numVertices; i++) {
+        if (graph->nodes[i].url && strcmp(graph->nodes[i].url, url) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int getEdgeWeight(Graph* graph, int from, int to) {
+    if (graph->disk) return diskGraphFindWeight(graph->disk, from, to);
+    if (graph->outAdj) return adjFindWeight(graph->outAdj, from, to);
+    return graph->adjMatrix[from][to];
+}
+
+// Returns 1 if target can be reached from source along nonzero edges, 0 if
+// not and -1 if out of memory or the adjacency file could not be read. The
+// index settles pairs it can rule out; everything else is confirmed by a
+// forward BFS, since deletions leave the index over-approximating.
+int canReach(Graph* graph, int source, int target) {
+    if (source < 0 || target < 0 ||
+        source >= graph->numVertices || target >= graph->numVertices) return 0;
+    if (source == target) return 1;
+
+    pthread_rwlock_rdlock(&graph->lock);
+    if (graph->reachIndex && !reachIndexMayReach(graph->reachIndex, source, target)) {
+        pthread_rwlock_unlock(&graph->lock);
+        return 0;
+    }
+
+    int* queue = (int*)malloc(graph->numVertices * sizeof(int));
+    char* seen = (char*)calloc(graph->numVertices, sizeof(char));
+    DiskEdge* edges = graph->disk ?
+        (DiskEdge*)malloc((graph->disk->maxDegree + 1) * sizeof(DiskEdge)) : NULL;
+    if (!queue || !seen || (graph->disk && !edges)) {
+        pthread_rwlock_unlock(&graph->lock);
+        free(queue);
+        free(seen);
+        free(edges);
+        return -1;
+    }
+
+    int found = 0, front = 0, rear = 0, ahead = 0;
+    queue[rear++] = source;
+    seen[source] = 1;
+    while (front < rear && !found && graph->disk) {
+        int u = queue[front++];
+        int degree = diskGraphNeighbours(graph->disk, u, 1, edges);
+        if (degree < 0) found = -1;
+        for (int j = 0; j < degree; j++) {
+            int v = edges[j].dest;
+            if (seen[v] || edges[j].weight == 0) continue;
+            if (v == target) {
+                found = 1;
+                break;
+            }
+            seen[v] = 1;
+            queue[rear++] = v;
+        }
+        // Start reading the lists the next few dequeues will need
+        if (ahead < front) ahead = front;
+        int until = rear < front + DISK_READAHEAD ? rear : front + DISK_READAHEAD;
+        if (until > ahead) {
+            diskGraphReadahead(graph->disk, queue + ahead, until - ahead, 1);
+            ahead = until;
+        }
+    }
+    while (front < rear && !found && !graph->disk) {
+        int u = queue[front++];
+        EdgeCursor cursor;
+        int v, weight;
+        outEdgesBegin(graph, u, &cursor);
+        while (outEdgesNext(&cursor, &v, &weight)) {
+            if (seen[v] || weight == 0) continue;
+            if (v == target) {
+                found = 1;
+                break;
+            }
+            seen[v] = 1;
+            queue[rear++] = v;
+        }
+    }
+    pthread_rwlock_unlock(&graph->lock);
+
+    free(queue);
+    free(seen);
+    free(edges);
+    return found;
+}
+
+// The id v had before any reordering, which is what reports show so that
+// they match the input whatever order the vertices were moved into
+int originalVertexId(const Graph* graph, int v) {
+    return graph->originalId ? graph->originalId[v] : v;
+}
+
+int hasVertexUrl(Graph* graph, int v) {
+    return (graph->nodes && graph->nodes[v].url != NULL) ||
+           (graph->urlDict && graph->urlRank[v] != -1);
+}
+
+// Returns the URL of v, decoding it into buf (MAX_URL_LENGTH bytes) when it
+// lives in the dictionary. Returns NULL for vertices without a URL.
+const char* getVertexUrl(Graph* graph, int v, char* buf) {
+    if (graph->nodes && graph->nodes[v].url) return graph->nodes[v].url;
+    if (!graph->urlDict || graph->urlRank[v] == -1) return NULL;
+    return urlDictGet(graph->urlDict, graph->urlRank[v], buf, MAX_URL_LENGTH);
+}
+
+// Moves every URL into one sorted, front-coded dictionary and frees the
+// per-vertex strdup copies
+void compactUrls(Graph* graph) {
+    if (graph->urlDict) return;
+
+    const char** urls = (const char**)malloc(graph->numVertices * sizeof(char*));
+    int* owner = (int*)malloc(graph->numVertices * sizeof(int));
+    int* rankOf = (int*)malloc(graph->numVertices * sizeof(int));
+    int* urlRank = (int*)malloc(graph->numVertices * sizeof(int));
+    if (!urls || !owner || !rankOf || !urlRank) {
+        free(urls);
+        free(owner);
+        free(rankOf);
+        free(urlRank);
+        return;
+    }
+
+    int n = 0;
+    size_t before = 0;
+    for (int v = 0; v < graph->numVertices; v++) {
+        urlRank[v] = -1;
+        if (graph->nodes[v].url) {
+            urls[n] = graph->nodes[v].url;
+            owner[n++] = v;
+            before += strlen(graph->nodes[v].url) + 1;
+        }
+    }
+
+    UrlDict* dict = buildUrlDict(urls, n, rankOf);
+    int* rankVertex = (int*)malloc((n + 1) * sizeof(int));
+    if (!dict || !rankVertex) {
+        printf("Error: Not enough memory to compact URLs\n");
+        freeUrlDict(dict);
+        free(rankVertex);
+        free(urls);
+        free(owner);
+        free(rankOf);
+        free(urlRank);
+        return;
+    }
+
+    for (int i = 0; i < n; i++) {
+        urlRank[owner[i]] = rankOf[i];
+        rankVertex[rankOf[i]] = owner[i];
+        free(graph->nodes[owner[i]].url);
+        graph->nodes[owner[i]].url = NULL;
+    }
+    graph->urlDict = dict;
+    graph->urlRank = urlRank;
+    graph->rankVertex = rankVertex;
+    memRelease(&graph->memory, MEM_URLS, before);
+    memReserve(&graph->memory, MEM_URLS, urlDictBytes(dict) +
+               (size_t)(graph->numVertices + n) * sizeof(int));
+
+    printf("Compacted %d URLs into %zu bytes (was %zu bytes in %d allocations)\n",
+           n, urlDictBytes(dict), before, n);
+
+    free(urls);
+    free(owner);
+    free(rankOf);
+}
+
+void processUrlFile(Graph* graph, const char* filename) {
+    FILE* file = fopen(filename, "r");
+    if (!file) {
+        printf("Error: Cannot open file '%s'\n", filename);
+        return;
+    }
+
+    char fromUrl[MAX_URL_LENGTH], toUrl[MAX_URL_LENGTH];
+    int weight;
+    int nextVertex = 0;
+    char line[MAX_URL_LENGTH * 2 + 50];  // Buffer for whole line
+    
+    EdgeBuilder* builder = createEdgeBuilder(graph->numVertices);
+    if (!builder) {
+        printf("Error: Cannot allocate edge buffer\n");
+        fclose(file);
+        return;
+    }
+
+    printf("Starting to read file '%s'...\n", filename);
+    
+    while (fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\n")] = '\0';
+        
+        char* fromUrlToken = strtok(line, ",");
+        char* toUrlToken = strtok(NULL, ",");
+        char* weightToken = strtok(NULL, ",");
+        
+        if (fromUrlToken && toUrlToken && weightToken) {
+            weight = atoi(weightToken);
+            
+            strncpy(fromUrl, fromUrlToken, MAX_URL_LENGTH - 1);
+            strncpy(toUrl, toUrlToken, MAX_URL_LENGTH - 1);
+            fromUrl[MAX_URL_LENGTH - 1] = '\0';
+            toUrl[MAX_URL_LENGTH - 1] = '\0';
+            
+            if (strlen(fromUrl) >= MAX_URL_LENGTH || strlen(toUrl) >= MAX_URL_LENGTH) {
+                printf("Warning: URL too long, skipping line\n");
+                continue;
+            }
+            
+            if (weight < 0) {
+                printf("Warning: Negative weight found, using absolute value\n");
+                weight = abs(weight);
+            }
+            
+            int fromIndex = findVertexByUrl(graph, fromUrl);
+            if (fromIndex == -1) {
+                if (nextVertex >= graph->numVertices) {
+                    printf("Error: Maximum number of vertices reached\n");
+                    break;
+                }
+                if (!memReserve(&graph->memory, MEM_URLS, strlen(fromUrl) + 1)) {
+                    printf("Error: Storing URL '%s' would exceed the memory budget\n", fromUrl);
+                    break;
+                }
+                fromIndex = nextVertex++;
+                graph->nodes[fromIndex].url = strdup(fromUrl);
+                printf("Created new vertex for %s at index %d\n", fromUrl, fromIndex);
+            }
+
+            int toIndex = findVertexByUrl(graph, toUrl);
+            if (toIndex == -1) {
+                if (nextVertex >= graph->numVertices) {
+                    printf("Error: Maximum number of vertices reached\n");
+                    break;
+                }
+                if (!memReserve(&graph->memory, MEM_URLS, strlen(toUrl) + 1)) {
+                    printf("Error: Storing URL '%s' would exceed the memory budget\n", toUrl);
+                    break;
+                }
+                toIndex = nextVertex++;
+                graph->nodes[toIndex].url = strdup(toUrl);
+                printf("Created new vertex for %s at index %d\n", toUrl, toIndex);
+            }
+
+            if (!edgeBuilderAdd(builder, fromIndex, toIndex, weight)) {
+                printf("Error: Not enough memory to buffer edge %s -> %s\n", fromUrl, toUrl);
+                break;
+            }
+            printf("Added edge: %s -> %s (Weight: %d)\n", fromUrl, toUrl, weight);
+        } else {
+            printf("Warning: Invalid line format: %s\n", line);
+        }
+    }
+    
+    if (ferror(file)) {
+        printf("Error: Failed to read file\n");
+    } else if (feof(file)) {
+        printf("Finished reading file. Processed %d vertices\n", nextVertex);
+    }
+    
+    fclose(file);
+
+    // Build all adjacency in one pass, merging repeated src->dest lines
+    EdgeList* list = buildEdgeList(builder, nextVertex, graph->duplicatePolicy, 0);
+    if (list) {
+        if (list->numDuplicates > 0) {
+            printf("Merged %d duplicate edges\n", list->numDuplicates);
+        }
+        loadGraphFromEdgeList(graph, list);
+        freeEdgeList(list);
+    }
+    freeEdgeBuilder(builder);
+}
+
+// Loads every shard file matched by a directory or glob in parallel. Vertex
+// ids come out the same as if the shards had been concatenated in sorted
+// path order and passed to processUrlFile.
+void processUrlShards(Graph* graph, const char* pattern) {
+    printf("Starting to read shards '%s'...\n", pattern);
+    ShardIngest* ingest = ingestShards(pattern, MAX_URL_LENGTH, 0);
+    if (!ingest) return;
+
+    if (ingest->numUrls > graph->numVertices) {
+        printf("Error: Shards contain %d URLs but the graph only holds %d vertices\n",
+               ingest->numUrls, graph->numVertices);
+        freeShardIngest(ingest);
+        return;
+    }
+    size_t urlBytes = 0;
+    for (int v = 0; v < ingest->numUrls; v++) urlBytes += strlen(ingest->urls[v]) + 1;
+    if (!memReserve(&graph->memory, MEM_URLS, urlBytes)) {
+        printf("Error: Storing %d URLs would exceed the memory budget\n", ingest->numUrls);
+        freeShardIngest(ingest);
+        return;
+    }
+    for (int v = 0; v < ingest->numUrls; v++) {
+        free(graph->nodes[v].url);
+        graph->nodes[v].url = ingest->urls[v];
+        ingest->urls[v] = NULL;
+    }
+
+    EdgeList* list = buildEdgeList(ingest->edges, ingest->numUrls, graph->duplicatePolicy, 0);
+    if (list) {
+        printf("Loaded %d shards: %ld lines, %d URLs, %d edges\n", ingest->numShards,
+               ingest->numLines, ingest->numUrls, list->numEdges);
+        if (list->numDuplicates > 0) {
+            printf("Merged %d duplicate edges\n", list->numDuplicates);
+        }
+        loadGraphFromEdgeList(graph, list);
+        freeEdgeList(list);
+    }
+    freeShardIngest(ingest);
+}
+
+void freeGraph(Graph* graph) {
+    if (!graph) return;
+    
+    for (int i = 0; graph->nodes && i < graph->numVertices; i++) {
+        free(graph->adjMatrix[i]);
+        free(graph->nodes[i].url);
+        free(graph->nodes[i].edges);
+    }
+    free(graph->adjMatrix);
+    free(graph->originalId);
+    freeUrlDict(graph->urlDict);
+    free(graph->urlRank);
+    free(graph->rankVertex);
+    freeCompressedAdjacency(graph->outAdj);
+    freeCompressedAdjacency(graph->inAdj);
+    freeReachIndex(graph->reachIndex);
+    freeEdgeIndex(graph->edgeIndex);
+    free(graph->unsortedEdges);
+    pthread_rwlock_destroy(&graph->lock);
+    destroyMemAccount(&graph->memory);
+    freePathCache(graph->pathCache);
+    closeDiskGraph(graph->disk);
+    free(graph->nodes);
+    free(graph);
+}
+
+void printWeightedEdgeList(Graph* graph) {
+    if (graph->disk) {
+        printf("Error: Printing the edges needs the graph in memory, not on disk\n");
+        return;
+    }
+    char fromBuf[MAX_URL_LENGTH], toBuf[MAX_URL_LENGTH];
+    printf("\n=== Weighted Edge List ===\n");
+    printf("From URL -> To URL (Weight)\n");
+    printf("----------------------------------------\n");
+    for (int i = 0; i < graph->numVertices; i++) {
+        if (hasVertexUrl(graph, i)) {
+            EdgeCursor cursor;
+            int destIndex, weight;
+            outEdgesBegin(graph, i, &cursor);
+            while (outEdgesNext(&cursor, &destIndex, &weight)) {
+                printf("%-30s -> %-30s (Weight: %d)\n",
+                    getVertexUrl(graph, i, fromBuf),
+                    getVertexUrl(graph, destIndex, toBuf),
+                    weight);
+            }
+        }
+    }
+}
+
+void printAdjacencyList(Graph* graph) {
+    if (graph->disk) {
+        printf("Error: Printing the edges needs the graph in memory, not on disk\n");
+        return;
+    }
+    char fromBuf[MAX_URL_LENGTH], toBuf[MAX_URL_LENGTH];
+    printf("\n=== Weighted Adjacency List ===\n");
+    printf("URL -> [Destination URLs]\n");
+    printf("----------------------------------------\n");
+    for (int i = 0; i < graph->numVertices; i++) {
+        if (hasVertexUrl(graph, i)) {
+            printf("%-30s ->", getVertexUrl(graph, i, fromBuf));
+            EdgeCursor cursor;
+            int destIndex, weight;
+            outEdgesBegin(graph, i, &cursor);
+            while (outEdgesNext(&cursor, &destIndex, &weight)) {
+                printf(" %s (%d)", 
+                    getVertexUrl(graph, destIndex, toBuf),
+                    weight);
+            }
+            printf("\n");
+        }
+    }
+}
+
+void printAdjacencyMatrix(Graph* graph) {
+    if (graph->disk) {
+        printf("Error: Printing the edges needs the graph in memory, not on disk\n");
+        return;
+    }
+    printf("\n=== Weighted Adjacency Matrix ===\n");
+    printf("%5s", "");
+    for (int i = 0; i < graph->numVertices; i++) {
+        if (hasVertexUrl(graph, i)) {
+            printf("%5d ", originalVertexId(graph, i));
+        }
+    }
+    printf("\n%5s", "");
+    for (int i = 0; i < graph->numVertices; i++) {
+        if (hasVertexUrl(graph, i)) {
+            printf("------");
+        }
+    }
+    printf("\n");
+    for (int i = 0; i < graph->numVertices; i++) {
+        if (hasVertexUrl(graph, i)) {
+            printf("[%3d] ", originalVertexId(graph, i));
+            for (int j = 0; j < graph->numVertices; j++) {
+                if (hasVertexUrl(graph, j)) {
+                    printf("%5d ", graph->adjMatrix[i][j]);
+                }
+            }
+            printf("\n");
+        }
+    }
+}
+
+// Opens a DOT file with a large stdio buffer so that big exports go out
+// in a few large writes instead of one per fprintf
+FILE* openDotFile(const char* filename, char** buffer) {
+    FILE* file = fopen(filename, "w");
+    if (!file) return NULL;
+    *buffer = (char*)malloc(DOT_BUFFER_SIZE);
+    if (*buffer) setvbuf(file, *buffer, _IOFBF, DOT_BUFFER_SIZE);
+    return file;
+}
+
+void closeDotFile(FILE* file, char* buffer) {
+    fclose(file);
+    free(buffer);
+}
+
+// In-neighbour lists in CSR form, counted and filled from the out-edges in
+// O(V + E), for graphs without inAdj. The sources of v are
+// (*sources)[(*offsets)[v] .. (*offsets)[v + 1]). Returns 0 if out of memory.
+int buildReverseLists(Graph* graph, int** offsets, int** sources) {
+    if (graph->disk) return 0;
+    int n = graph->numVertices;
+    *offsets = (int*)calloc(n + 1, sizeof(int));
+    int numEdges = 0;
+    for (int u = 0; u < n; u++) numEdges += graph->nodes[u].numEdges;
+    *sources = (int*)malloc((numEdges + 1) * sizeof(int));
+    if (!*offsets || !*sources) {
+        free(*offsets);
+        free(*sources);
+        return 0;
+    }
+
+    for (int u = 0; u < n; u++) {
+        EdgeCursor cursor;
+        int v, weight;
+        outEdgesBegin(graph, u, &cursor);
+        while (outEdgesNext(&cursor, &v, &weight)) (*offsets)[v + 1]++;
+    }
+    for (int v = 0; v < n; v++) (*offsets)[v + 1] += (*offsets)[v];
+    //offsets[v] serves as v's fill position, then everything shifts back
+    for (int u = 0; u < n; u++) {
+        EdgeCursor cursor;
+        int v, weight;
+        outEdgesBegin(graph, u, &cursor);
+        while (outEdgesNext(&cursor, &v, &weight)) (*sources)[(*offsets)[v]++] = u;
+    }
+    for (int v = n; v > 0; v--) (*offsets)[v] = (*offsets)[v - 1];
+    (*offsets)[0] = 0;
+    return 1;
+}
+
+// Flags every vertex within hops steps of a seed, following edges in
+// either direction. In-edges come from inAdj or from reverse lists built
+// once per call, so the cost is O(V + E) at most and the traversal itself
+// only touches the neighbourhood.
+int collectNeighbourhood(Graph* graph, const int* seeds, int numSeeds,
+                         int hops, char* inSet) {
+    if (graph->disk) return -1;
+    int* queue = (int*)malloc(graph->numVertices * sizeof(int));
+    int* depth = (int*)malloc(graph->numVertices * sizeof(int));
+    int* inOffsets = NULL;
+    int* inSources = NULL;
+    if (!queue || !depth ||
+        (!graph->inAdj && !buildReverseLists(graph, &inOffsets, &inSources))) {
+        free(queue);
+        free(depth);
+        return -1;
+    }
+
+    int front = 0, rear = 0;
+    for (int i = 0; i < numSeeds; i++) {
+        if (inSet[seeds[i]]) continue;
+        inSet[seeds[i]] = 1;
+        depth[seeds[i]] = 0;
+        queue[rear++] = seeds[i];
+    }
+
+    while (front < rear) {
+        int u = queue[front++];
+        if (depth[u] == hops) continue;
+
+        EdgeCursor cursor;
+        int v, weight;
+        outEdgesBegin(graph, u, &cursor);
+        while (outEdgesNext(&cursor, &v, &weight)) {
+            if (!inSet[v]) {
+                inSet[v] = 1;
+                depth[v] = depth[u] + 1;
+                queue[rear++] = v;
+            }
+        }
+        if (graph->inAdj) {
+            AdjIterator it;
+            adjBegin(graph->inAdj, u, &it);
+            while (adjNext(&it, &v, &weight)) {
+                if (!inSet[v]) {
+                    inSet[v] = 1;
+                    depth[v] = depth[u] + 1;
+                    queue[rear++] = v;
+                }
+            }
+        } else {
+            for (int j = inOffsets[u]; j < inOffsets[u + 1]; j++) {
+                int v = inSources[j];
+                if (!inSet[v]) {
+                    inSet[v] = 1;
+                    depth[v] = depth[u] + 1;
+                    queue[rear++] = v;
+                }
+            }
+        }
+    }
+
+    free(queue);
+    free(depth);
+    free(inOffsets);
+    free(inSources);
+    return rear;
+}
+
+void writeGraphToDot(Graph* graph, const char* filename) {
+    if (graph->disk) {
+        printf("Error: DOT export needs the graph in memory, not on disk\n");
+        return;
+    }
+    char fromBuf[MAX_URL_LENGTH], toBuf[MAX_URL_LENGTH];
+    char* buffer = NULL;
+    FILE* file = openDotFile(filename, &buffer);
+    if (!file) return;
+
+    fprintf(file, "digraph G {\n");
+    fprintf(file, "  node [shape=box];\n");
+    fprintf(file, "  rankdir=LR;\n");
+    
+    // Add all nodes first
+    for (int i = 0; i < graph->numVertices; i++) {
+        if (hasVertexUrl(graph, i)) {
+            const char* url = getVertexUrl(graph, i, fromBuf);
+            fprintf(file, "  \"%s\" [label=\"%s\"];\n", url, url);
+        }
+    }
+    
+    // Add all edges
+    for (int i = 0; i < graph->numVertices; i++) {
+        EdgeCursor cursor;
+        int dest, weight;
+        outEdgesBegin(graph, i, &cursor);
+        while (outEdgesNext(&cursor, &dest, &weight)) {
+            fprintf(file, "  \"%s\" -> \"%s\" [label=\"%d\"];\n",
+                getVertexUrl(graph, i, fromBuf),
+                getVertexUrl(graph, dest, toBuf),
+                weight);
+        }
+    }
+    fprintf(file, "}\n");
+    closeDotFile(file, buffer);
+}
@@ -0,0 +1,135 @@
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "edgebuilder.h"
+#include "vertexorder.h"
+#include "urldict.h"
+#include "compressedadj.h"
+#include "reachindex.h"
+#include "edgeindex.h"
+#include "shardingest.h"
+#include "memaccount.h"
+#include "pathcache.h"
+#include "querycontext.h"
+#include "diskgraph.h"
+#include <pthread.h>
+
+#define MAX_URL_LENGTH 256
+#define DOT_BUFFER_SIZE (1 << 20)
+
+typedef struct Edge {
+    int dest;
+    int weight;
+} Edge;
+
+typedef struct Node {
+    int vertex;
+    char* url;
+    Edge* edges;
+    int numEdges;
+    int edgeCapacity;
+} Node;
+
+// The link graph shared by the flow (edgraph) and search (bdgraph) layers.
+// version changes whenever an edge does, so cached answers can tell when
+// they are stale. Once compressed, nodes keep their URL and degree but
+// their edges live only in outAdj/inAdj. A disk-resident graph has no
+// nodes or matrix: its adjacency is read through disk and it cannot be
+// changed.
+typedef struct Graph {
+    Node* nodes;
+    int** adjMatrix;
+    int numVertices;
+    DuplicatePolicy duplicatePolicy;
+    int* originalId;
+    UrlDict* urlDict;
+    int* urlRank;
+    int* rankVertex;
+    CompressedAdjacency* outAdj;
+    CompressedAdjacency* inAdj;
+    ReachIndex* reachIndex;
+    EdgeIndex* edgeIndex;
+    char* unsortedEdges;
+    int pendingUpdates;
+    int wantCompressed;
+    int wantReachIndex;
+    pthread_rwlock_t lock;
+    MemAccount memory;
+    unsigned long version;
+    PathCache* pathCache;
+    DiskGraph* disk;
+} Graph;
+
+// Walks the out-edges of a vertex in dest order. After compressGraph the
+// Edge arrays are freed and the edges are decoded from outAdj instead.
+typedef struct EdgeCursor {
+    int compressed;
+    const Edge* edges;
+    int index;
+    int count;
+    AdjIterator adj;
+} EdgeCursor;
+
+static inline void outEdgesBegin(const Graph* graph, int u, EdgeCursor* cursor) {
+    cursor->compressed = graph->outAdj != NULL;
+    cursor->edges = graph->nodes[u].edges;
+    cursor->index = 0;
+    cursor->count = graph->nodes[u].numEdges;
+    if (cursor->compressed) {
+        adjBegin(graph->outAdj, u, &cursor->adj);
+    } else {
+        memset(&cursor->adj, 0, sizeof(AdjIterator));
+    }
+}
+
+static inline int outEdgesNext(EdgeCursor* cursor, int* dest, int* weight) {
+    if (cursor->compressed) return adjNext(&cursor->adj, dest, weight);
+    if (cursor->index == cursor->count) return 0;
+    *dest = cursor->edges[cursor->index].dest;
+    *weight = cursor->edges[cursor->index].weight;
+    cursor->index++;
+    return 1;
+}
+
+Graph* createGraph(int vertices);
+Graph* createGraphWithBudget(int vertices, size_t budget);
+Graph* openDiskResidentGraph(const char* filename, size_t cacheBytes, size_t budget);
+void addEdge(Graph* graph, int src, int dest, int weight);
+void loadGraphFromEdgeList(Graph* graph, EdgeList* list);
+void reorderGraph(Graph* graph, VertexOrder order);
+void compressGraph(Graph* graph);
+void buildReachability(Graph* graph);
+void dropReachIndex(Graph* graph);
+int applyEdgeUpdates(Graph* graph, const EdgeUpdate* updates, int count);
+int removeEdge(Graph* graph, int src, int dest);
+int setEdgeWeight(Graph* graph, int src, int dest, int weight);
+void compactGraph(Graph* graph);
+int processUpdateFile(Graph* graph, const char* filename);
+int findVertexByUrl(Graph* graph, const char* url);
+int getEdgeWeight(Graph* graph, int from, int to);
+int canReach(Graph* graph, int source, int target);
+int hasVertexUrl(Graph* graph, int v);
+int originalVertexId(const Graph* graph, int v);
+const char* getVertexUrl(Graph* graph, int v, char* buf);
+void compactUrls(Graph* graph);
+void processUrlFile(Graph* graph, const char* filename);
+void processUrlShards(Graph* graph, const char* pattern);
+void freeGraph(Graph* graph);
+
+void printWeightedEdgeList(Graph* graph);
+void printAdjacencyList(Graph* graph);
+void printAdjacencyMatrix(Graph* graph);
+void writeGraphToDot(Graph* graph, const char* filename);
+
+// Helpers for the layers' own DOT exports
+FILE* openDotFile(const char* filename, char** buffer);
+void closeDotFile(FILE* file, char* buffer);
+int buildReverseLists(Graph* graph, int** offsets, int** sources);
+int collectNeighbourhood(Graph* graph, const int* seeds, int numSeeds,
+                         int hops, char* inSet);
+
+#endif
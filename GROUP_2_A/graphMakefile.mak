@@ -0,0 +1,19 @@
+CC = gcc
+LDLIBS = -pthread
+
+SOURCES = graphmain.c
+
+TARGET = graphprogram
+
+run: $(TARGET)
+	printf "links.txt\nflow http://example.com http://example.com/blog/post5\npath http://example.com http://example.com/blog/post5\nreach http://example.com/blog/post5 http://example.com\nquit\n" | ./$(TARGET)
+
+include graphlib.mak
+
+$(TARGET): $(SOURCES) $(LIB)
+	$(CC) $(SOURCES) $(LIB) -o $(TARGET) $(LDLIBS)
+
+clean: lib-clean
+	rm -f $(TARGET)
+
+.PHONY: run clean lib-clean
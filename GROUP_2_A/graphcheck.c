@@ -0,0 +1,321 @@
+#include <unistd.h>
+#include <fcntl.h>
+#include "graph.h"
+#include "edgraph.h"
+#include "bdgraph.h"
+
+// Random-graph regression check for the flow kernel, the approximate flow
+// and the path counting and enumeration. Every answer is compared with a
+// small reference computed here on an adjacency matrix: Edmonds-Karp for
+// the flows and a DFS over all simple paths for the path queries.
+// Prints the number of mismatches and exits non-zero if there were any.
+
+#define CHECK_MAX_VERTICES 16
+#define CHECK_MAX_PATHS 4096
+
+static unsigned long long checkSeed = 88172645463325252ULL;
+static int failures = 0;
+static int savedStdout = -1;
+
+static int randomInt(int lo, int hi) {
+    checkSeed ^= checkSeed << 13;
+    checkSeed ^= checkSeed >> 7;
+    checkSeed ^= checkSeed << 17;
+    return lo + (int)(checkSeed % (unsigned long long)(hi - lo + 1));
+}
+
+// The library reports as it goes; that output is dropped while checking
+static void muteOutput(int mute) {
+    fflush(stdout);
+    if (mute) {
+        int devNull = open("/dev/null", O_WRONLY);
+        savedStdout = dup(STDOUT_FILENO);
+        dup2(devNull, STDOUT_FILENO);
+        close(devNull);
+    } else {
+        dup2(savedStdout, STDOUT_FILENO);
+        close(savedStdout);
+    }
+}
+
+static void fail(const char* what, int trial) {
+    fprintf(stderr, "Mismatch in %s, trial %d\n", what, trial);
+    failures++;
+}
+
+typedef struct RandomGraph {
+    int n;
+    int cap[CHECK_MAX_VERTICES][CHECK_MAX_VERTICES];
+    int present[CHECK_MAX_VERTICES];
+    char urls[CHECK_MAX_VERTICES][32];
+} RandomGraph;
+
+static void makeRandomGraph(RandomGraph* g, int maxVertices, int maxDensity, int maxCapacity) {
+    memset(g, 0, sizeof(RandomGraph));
+    g->n = randomInt(3, maxVertices);
+    int density = randomInt(15, maxDensity);
+    for (int u = 0; u < g->n; u++) {
+        snprintf(g->urls[u], sizeof(g->urls[u]), "http://v%d", u);
+        for (int v = 0; v < g->n; v++) {
+            if (u != v && randomInt(1, 100) <= density) {
+                g->cap[u][v] = randomInt(1, maxCapacity);
+                g->present[u] = g->present[v] = 1;
+            }
+        }
+    }
+}
+
+// Loads g through the links file reader, like the frontends do
+static Graph* loadRandomGraph(const RandomGraph* g, int compress) {
+    char filename[] = "/tmp/graphcheckXXXXXX";
+    int fd = mkstemp(filename);
+    if (fd < 0) return NULL;
+    FILE* file = fdopen(fd, "w");
+    for (int u = 0; u < g->n; u++) {
+        for (int v = 0; v < g->n; v++) {
+            if (g->cap[u][v]) fprintf(file, "%s,%s,%d\n", g->urls[u], g->urls[v], g->cap[u][v]);
+        }
+    }
+    fclose(file);
+    Graph* graph = createGraph(CHECK_MAX_VERTICES);
+    if (graph) {
+        processUrlFile(graph, filename);
+        if (compress) compressGraph(graph);
+    }
+    remove(filename);
+    return graph;
+}
+
+// Picks a vertex that has at least one link, or -1
+static int randomVertex(const RandomGraph* g, int other) {
+    int candidates[CHECK_MAX_VERTICES], count = 0;
+    for (int v = 0; v < g->n; v++) {
+        if (g->present[v] && v != other) candidates[count++] = v;
+    }
+    return count ? candidates[randomInt(0, count - 1)] : -1;
+}
+
+static long long referenceMaxFlow(const RandomGraph* g, int source, int sink) {
+    long long residual[CHECK_MAX_VERTICES][CHECK_MAX_VERTICES];
+    int parent[CHECK_MAX_VERTICES], queue[CHECK_MAX_VERTICES];
+    long long flow = 0;
+    for (int u = 0; u < g->n; u++) {
+        for (int v = 0; v < g->n; v++) residual[u][v] = g->cap[u][v];
+    }
+    while (1) {
+        for (int v = 0; v < g->n; v++) parent[v] = -1;
+        parent[source] = source;
+        int front = 0, rear = 0;
+        queue[rear++] = source;
+        while (front < rear && parent[sink] == -1) {
+            int u = queue[front++];
+            for (int v = 0; v < g->n; v++) {
+                if (parent[v] == -1 && residual[u][v] > 0) {
+                    parent[v] = u;
+                    queue[rear++] = v;
+                }
+            }
+        }
+        if (parent[sink] == -1) return flow;
+        long long bottleneck = LLONG_MAX;
+        for (int v = sink; v != source; v = parent[v]) {
+            if (residual[parent[v]][v] < bottleneck) bottleneck = residual[parent[v]][v];
+        }
+        for (int v = sink; v != source; v = parent[v]) {
+            residual[parent[v]][v] -= bottleneck;
+            residual[v][parent[v]] += bottleneck;
+        }
+        flow += bottleneck;
+    }
+}
+
+#define CHECK_FLOWS_PER_GRAPH 4
+
+// Exact flows, with and without capacity scaling, on unit capacities and
+// across all three residual widths; epsilon runs must stay within their
+// bounds. The capacities are kept, so one graph serves several pairs.
+static void checkFlows(int trials, int approximate) {
+    static const int capacities[] = {1, 9, 200, 70000};
+    for (int trial = 0; trial < trials; trial++) {
+        RandomGraph g;
+        //dense enough that paths often have to cancel earlier flow
+        makeRandomGraph(&g, CHECK_MAX_VERTICES, 80, capacities[trial % 4]);
+        int sources[CHECK_FLOWS_PER_GRAPH], sinks[CHECK_FLOWS_PER_GRAPH];
+        long long flows[CHECK_FLOWS_PER_GRAPH];
+        double epsilons[CHECK_FLOWS_PER_GRAPH];
+        FlowBounds bounds[CHECK_FLOWS_PER_GRAPH];
+        int numPairs = 0;
+        for (int i = 0; i < CHECK_FLOWS_PER_GRAPH; i++) {
+            sources[numPairs] = randomVertex(&g, -1);
+            sinks[numPairs] = sources[numPairs] == -1 ? -1 : randomVertex(&g, sources[numPairs]);
+            if (sinks[numPairs] != -1) numPairs++;
+        }
+        if (numPairs == 0) continue;
+
+        muteOutput(1);
+        Graph* graph = loadRandomGraph(&g, trial % 2);
+        for (int i = 0; i < numPairs; i++) {
+            FlowOptions options;
+            memset(&options, 0, sizeof(FlowOptions));
+            options.keepCapacities = 1;
+            options.quiet = 1;
+            options.capacityScaling = randomInt(0, 1);
+            options.bounds = &bounds[i];
+            options.epsilon = epsilons[i] = approximate ? randomInt(1, 50) / 100.0 : 0;
+            const char* sourceUrl = g.urls[sources[i]];
+            const char* sinkUrl = g.urls[sinks[i]];
+            flows[i] = graph ? edmondsKarpMulti(graph, &sourceUrl, 1, &sinkUrl, 1, &options) : -1;
+        }
+        freeGraph(graph);
+        muteOutput(0);
+
+        for (int i = 0; i < numPairs; i++) {
+            long long exact = referenceMaxFlow(&g, sources[i], sinks[i]);
+            if (!approximate) {
+                if (flows[i] != exact || !bounds[i].complete) fail("exact max flow", trial);
+            } else if (flows[i] < 0 || flows[i] > exact || bounds[i].upperBound < exact ||
+                       (double)flows[i] < (1 - epsilons[i]) * (double)exact ||
+                       (bounds[i].complete && flows[i] != exact)) {
+                fail("approximate max flow", trial);
+            }
+        }
+    }
+}
+
+typedef struct PathSet {
+    int paths[CHECK_MAX_PATHS][CHECK_MAX_VERTICES];
+    int lengths[CHECK_MAX_PATHS];
+    int count;
+} PathSet;
+
+static void collectSimplePaths(const RandomGraph* g, int* path, int length, int target,
+                               int maxHops, char* onPath, PathSet* out) {
+    int u = path[length - 1];
+    if (maxHops && length - 1 > maxHops) return;
+    if (u == target) {
+        if (out->count < CHECK_MAX_PATHS) {
+            memcpy(out->paths[out->count], path, length * sizeof(int));
+            out->lengths[out->count++] = length;
+        }
+        return;
+    }
+    for (int v = 0; v < g->n; v++) {
+        if (g->cap[u][v] && !onPath[v]) {
+            onPath[v] = 1;
+            path[length] = v;
+            collectSimplePaths(g, path, length + 1, target, maxHops, onPath, out);
+            onPath[v] = 0;
+        }
+    }
+}
+
+static int compareInts(const void* a, const void* b) {
+    return *(const int*)a - *(const int*)b;
+}
+
+static int vertexOfUrl(Graph* graph, int v) {
+    char urlBuf[MAX_URL_LENGTH];
+    int id = -1;
+    sscanf(getVertexUrl(graph, v, urlBuf), "http://v%d", &id);
+    return id;
+}
+
+// Shortest path counts and the k shortest loopless paths, with and
+// without a hop cap, checked against every simple path
+static void checkPaths(int trials) {
+    static PathSet all;
+    for (int trial = 0; trial < trials; trial++) {
+        RandomGraph g;
+        //small enough to list every simple path
+        makeRandomGraph(&g, 10, 50, 1);
+        int source = randomVertex(&g, -1);
+        int target = source == -1 ? -1 : randomVertex(&g, source);
+        if (target == -1) continue;
+        static const int caps[] = {0, 0, 2, 3, 4};
+        int maxHops = caps[randomInt(0, 4)];
+        int k = randomInt(1, 12);
+
+        int path[CHECK_MAX_VERTICES];
+        char onPath[CHECK_MAX_VERTICES] = {0};
+        all.count = 0;
+        path[0] = source;
+        onPath[source] = 1;
+        collectSimplePaths(&g, path, 1, target, maxHops, onPath, &all);
+        if (all.count == CHECK_MAX_PATHS) continue;
+        int lengths[CHECK_MAX_PATHS];
+        memcpy(lengths, all.lengths, all.count * sizeof(int));
+        qsort(lengths, all.count, sizeof(int), compareInts);
+        unsigned long long shortest = 0;
+        for (int i = 0; i < all.count; i++) shortest += all.lengths[i] == lengths[0];
+
+        muteOutput(1);
+        Graph* graph = loadRandomGraph(&g, trial % 2);
+        PathCount count;
+        int counted = graph ? countShortestPaths(graph, g.urls[source], g.urls[target],
+                                                 maxHops, &count) : -1;
+        PathEnumerator* paths = graph ? startPathEnumeration(graph, g.urls[source],
+                                                             g.urls[target], maxHops) : NULL;
+        int found[CHECK_MAX_PATHS][CHECK_MAX_VERTICES];
+        int foundLengths[CHECK_MAX_PATHS];
+        int numFound = 0;
+        const Path* next;
+        while (paths && numFound < k && (next = nextShortestPath(paths)) != NULL) {
+            for (int i = 0; i < next->length && i < CHECK_MAX_VERTICES; i++) {
+                found[numFound][i] = vertexOfUrl(graph, next->path[i]);
+            }
+            foundLengths[numFound++] = next->length;
+        }
+        int started = paths != NULL;
+        freePathEnumerator(paths);
+        freeGraph(graph);
+        muteOutput(0);
+
+        if (counted < 0 || !started) {
+            fail("path query setup", trial);
+            continue;
+        }
+        if (all.count == 0) {
+            if (count.hops != -1 || numFound != 0) fail("unreachable target", trial);
+            continue;
+        }
+        if (count.hops != lengths[0] - 1 || count.count != shortest) {
+            fail("shortest path count", trial);
+        }
+        int expected = all.count < k ? all.count : k;
+        if (numFound != expected) {
+            fail("number of enumerated paths", trial);
+            continue;
+        }
+        for (int p = 0; p < numFound; p++) {
+            // Each path is one of the simple paths, in length order, and
+            // none is returned twice
+            int known = 0;
+            for (int q = 0; q < all.count && !known; q++) {
+                known = all.lengths[q] == foundLengths[p] &&
+                        memcmp(all.paths[q], found[p], foundLengths[p] * sizeof(int)) == 0;
+            }
+            int repeated = 0;
+            for (int q = 0; q < p && !repeated; q++) {
+                repeated = foundLengths[q] == foundLengths[p] &&
+                           memcmp(found[q], found[p], foundLengths[p] * sizeof(int)) == 0;
+            }
+            if (!known || repeated || foundLengths[p] != lengths[p]) {
+                fail("enumerated path", trial);
+                break;
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) checkSeed = strtoull(argv[1], NULL, 10) | 1;
+    checkFlows(2000, 0);
+    checkFlows(1200, 1);
+    checkPaths(300);
+    if (failures) {
+        printf("graphcheck: %d mismatches\n", failures);
+        return 1;
+    }
+    printf("graphcheck: flows, approximate flows and path queries agree with the reference\n");
+    return 0;
+}
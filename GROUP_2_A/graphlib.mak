@@ -0,0 +1,26 @@
+# Shared graph library: the core graph plus the flow and search layers.
+# Included by every frontend makefile, which links $(LIB) into its program.
+
+LIB_SOURCES = graph.c edgraph.c bdgraph.c edgebuilder.c vertexorder.c urldict.c compressedadj.c pathcache.c reachindex.c edgeindex.c flowkernel.c shardingest.c memaccount.c querycontext.c diskgraph.c
+
+LIB_OBJECTS = $(LIB_SOURCES:.c=.o)
+
+LIB = libwebgraph.a
+
+$(LIB): $(LIB_OBJECTS)
+	ar rcs $(LIB) $(LIB_OBJECTS)
+
+%.o: %.c
+	$(CC) -c $< -o $@
+
+# Compares the flow and path kernels with reference answers on random graphs
+check: graphcheck
+	./graphcheck
+
+graphcheck: graphcheck.c $(LIB)
+	$(CC) graphcheck.c $(LIB) -o graphcheck -pthread
+
+lib-clean:
+	rm -f $(LIB) $(LIB_OBJECTS) graphcheck
+
+.PHONY: check
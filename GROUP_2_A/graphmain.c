@@ -0,0 +1,301 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "edgraph.h"
+#include "bdgraph.h"
+
+#define MAX_VERTICES 1000
+
+// Paths listed by the paths command when no count is given
+#define DEFAULT_PATH_COUNT 5
+
+// Loads a link graph once and answers flow, shortest-path and reachability
+// queries against it, one command per line:
+//   flow SOURCE[,SOURCE...] SINK[,SINK...]
+//   path SOURCE TARGET
+//   paths SOURCE TARGET [K]
+//   count SOURCE TARGET
+//   reach SOURCE TARGET
+//   batch PAIRS_FILE
+//   update FILE
+//   stats
+//   quit
+// With --disk=ADJFILE the graph stays on disk and only the path, paths,
+// count, reach, batch, stats and quit commands are answered;
+// --build-disk=ADJFILE writes that file from a links file and exits.
+
+// Splits a comma-separated list of URLs in place, trimming spaces
+static int splitUrlList(char* line, const char** urls, int maxUrls) {
+    int count = 0;
+    for (char* token = strtok(line, ","); token && count < maxUrls; token = strtok(NULL, ",")) {
+        while (*token == ' ') token++;
+        char* end = token + strlen(token);
+        while (end > token && end[-1] == ' ') *--end = '\0';
+        if (*token) urls[count++] = token;
+    }
+    return count;
+}
+
+static void printCommands(void) {
+    printf("Commands:\n");
+    printf("  flow SOURCE[,SOURCE...] SINK[,SINK...]  maximum flow\n");
+    printf("  path SOURCE TARGET                      shortest path\n");
+    printf("  paths SOURCE TARGET [K]                 the K shortest loopless paths\n");
+    printf("  count SOURCE TARGET                     number of shortest paths\n");
+    printf("  reach SOURCE TARGET                     reachability\n");
+    printf("  batch PAIRS_FILE                        shortest paths for every pair\n");
+    printf("  update FILE                             apply an edge update file\n");
+    printf("  stats                                   memory and cache usage\n");
+    printf("  quit\n");
+}
+
+// The flow keeps the original capacities so later path and reachability
+// queries still see the graph as loaded
+static void runFlow(Graph* graph, char* sourceList, char* sinkList, const FlowOptions* defaults) {
+    const char* sources[MAX_VERTICES];
+    const char* sinks[MAX_VERTICES];
+    FlowOptions options = *defaults;
+    FlowReport report = {0};
+    FlowBounds bounds;
+    options.keepCapacities = 1;
+    options.quiet = 1;
+    options.report = &report;
+    options.bounds = &bounds;
+
+    int numSources = splitUrlList(sourceList, sources, MAX_VERTICES);
+    int numSinks = splitUrlList(sinkList, sinks, MAX_VERTICES);
+    long long maxFlow = edmondsKarpMulti(graph, sources, numSources, sinks, numSinks, &options);
+    if (maxFlow >= 0) {
+        printFlowReport(graph, &report);
+        if (!bounds.complete) {
+            printf("Stopped early: the maximum flow is between %lld and %lld\n",
+                   maxFlow, bounds.upperBound);
+        }
+    } else if (maxFlow == FLOW_INTERRUPTED) {
+        printf("Flow not computed: the query %s\n", queryStatusName(options.context->status));
+    } else if (!graph->disk) {
+        //a disk graph was already refused with its own message
+        printf("Error: Could not compute maximum flow. Check if URLs exist in the graph.\n");
+    }
+    freeFlowReport(&report);
+}
+
+static void runPath(Graph* graph, const char* source, const char* target, QueryContext* limits) {
+    Path* path = bidirectionalSearchWithContext(graph, source, target, limits);
+    if (!path) {
+        if (limits && limits->status != QUERY_OK) {
+            printf("No answer: the search %s\n", queryStatusName(limits->status));
+        } else {
+            printf("No path found between %s and %s\n", source, target);
+        }
+        return;
+    }
+    printPathDetails(graph, path);
+    printf("Number of hops: %d\n", path->length - 1);
+    freePath(path);
+}
+
+// --max-hops=H leaves out every path longer than H
+static void runPaths(Graph* graph, const char* source, const char* target, int k, int maxHops) {
+    PathEnumerator* paths = startPathEnumeration(graph, source, target, maxHops);
+    if (!paths) return;
+    int listed = 0;
+    const Path* path;
+    while (listed < k && (path = nextShortestPath(paths)) != NULL) {
+        printf("Path %d (%d hops):\n", ++listed, path->length - 1);
+        printPathDetails(graph, path);
+    }
+    if (listed == 0) {
+        printf("No path found between %s and %s\n", source, target);
+    } else if (listed < k) {
+        printf("Only %d path%s found\n", listed, listed == 1 ? "" : "s");
+    }
+    freePathEnumerator(paths);
+}
+
+static void runCount(Graph* graph, const char* source, const char* target, int maxHops) {
+    PathCount count;
+    if (countShortestPaths(graph, source, target, maxHops, &count) < 0) return;
+    if (count.hops < 0) {
+        printf("No path found between %s and %s\n", source, target);
+        return;
+    }
+    printf("%s%llu shortest path%s of %d hops (%d vertices and %d edges on them)\n",
+           count.saturated ? "At least " : "", count.count, count.count == 1 ? "" : "s",
+           count.hops, count.dagVertices, count.dagEdges);
+}
+
+static void runReach(Graph* graph, const char* source, const char* target) {
+    int s = findVertexByUrl(graph, source);
+    int t = findVertexByUrl(graph, target);
+    if (s == -1 || t == -1) {
+        printf("Error: Source or target URL not found in graph\n");
+        return;
+    }
+    int reachable = canReach(graph, s, t);
+    if (reachable < 0) {
+        printf("Error: Could not answer the reachability query\n");
+    } else {
+        printf("%s is %sreachable from %s\n", target, reachable ? "" : "not ", source);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    char filename[256];
+    char line[MAX_URL_LENGTH * 8];
+
+    VertexOrder order = ORDER_NONE;
+    int compress = 0;
+    FlowOptions flowOptions = {0};
+    int cacheSize = 0;
+    int numThreads = 0;
+    const char* updatesFile = NULL;
+    size_t memoryBudget = 0;
+    int haveFilename = 0;
+    const char* diskFile = NULL;
+    const char* buildDiskFile = NULL;
+    size_t diskCacheBytes = 0;
+    int maxHops = 0;
+    DuplicatePolicy duplicates = DUPLICATE_LAST;
+    QueryContext limits;
+    initQueryContext(&limits);
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--compress") == 0) {
+            compress = 1;
+        } else if (strcmp(argv[i], "--scaling") == 0) {
+            flowOptions.capacityScaling = 1;
+        } else if (strncmp(argv[i], "--deadline=", 11) == 0) {
+            flowOptions.deadlineSeconds = atof(argv[i] + 11) / 1000.0;
+        } else if (strncmp(argv[i], "--epsilon=", 10) == 0) {
+            flowOptions.epsilon = atof(argv[i] + 10);
+        } else if (parseQueryLimit(argv[i], &limits)) {
+            continue;
+        } else if (strncmp(argv[i], "--cache=", 8) == 0) {
+            cacheSize = atoi(argv[i] + 8);
+        } else if (strncmp(argv[i], "--threads=", 10) == 0) {
+            numThreads = atoi(argv[i] + 10);
+        } else if (strncmp(argv[i], "--updates=", 10) == 0) {
+            updatesFile = argv[i] + 10;
+        } else if (strncmp(argv[i], "--disk=", 7) == 0) {
+            diskFile = argv[i] + 7;
+        } else if (strncmp(argv[i], "--build-disk=", 13) == 0) {
+            buildDiskFile = argv[i] + 13;
+        } else if (strncmp(argv[i], "--disk-cache=", 13) == 0) {
+            diskCacheBytes = (size_t)atol(argv[i] + 13) << 20;
+        } else if (strncmp(argv[i], "--max-hops=", 11) == 0) {
+            maxHops = atoi(argv[i] + 11);
+        } else if (strncmp(argv[i], "--memory-budget=", 16) == 0) {
+            memoryBudget = (size_t)atol(argv[i] + 16) << 20;
+        } else if (strncmp(argv[i], "--reorder=", 10) == 0) {
+            if (!parseVertexOrder(argv[i] + 10, &order)) {
+                printf("Error: Unknown vertex order '%s' (use none, bfs, rcm or degree)\n",
+                       argv[i] + 10);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--duplicates=", 13) == 0) {
+            if (!parseDuplicatePolicy(argv[i] + 13, &duplicates)) {
+                printf("Error: Unknown duplicate policy '%s' (use sum, max or last)\n",
+                       argv[i] + 13);
+                return 1;
+            }
+        } else if (argv[i][0] == '-') {
+            printf("Usage: %s [--scaling] [--deadline=MS] [--epsilon=E] [--timeout=MS] [--max-settled=N] [--max-scanned=N] [--max-hops=H] [--compress] [--reorder=none|bfs|rcm|degree] [--duplicates=sum|max|last] [--cache=N] [--threads=N] [--updates=FILE] [--memory-budget=MB] [--disk=ADJFILE] [--disk-cache=MB] [--build-disk=ADJFILE] [FILE]\n", argv[0]);
+            return 1;
+        } else {
+            strncpy(filename, argv[i], sizeof(filename) - 1);
+            filename[sizeof(filename) - 1] = '\0';
+            haveFilename = 1;
+        }
+    }
+
+    // A disk-resident graph needs no links file
+    if (diskFile) haveFilename = 1;
+    if (!haveFilename) {
+        printf("Enter the filename containing URLs and links: ");
+        if (fgets(filename, sizeof(filename), stdin) == NULL) {
+            printf("Error reading filename\n");
+            return 1;
+        }
+        filename[strcspn(filename, "\n")] = '\0';
+    }
+
+    // The links are spooled to disk and sorted in ranges that fit the
+    // memory budget, so the file can be built for graphs larger than RAM
+    if (buildDiskFile) {
+        long long written = buildDiskGraph(filename, buildDiskFile, MAX_URL_LENGTH,
+                                           duplicates, memoryBudget);
+        return written < 0 ? 1 : 0;
+    }
+
+    Graph* graph;
+    if (diskFile) {
+        graph = openDiskResidentGraph(diskFile, diskCacheBytes, memoryBudget);
+        if (!graph) return 1;
+    } else {
+        graph = createGraphWithBudget(MAX_VERTICES, memoryBudget);
+        if (!graph) return 1;
+        graph->duplicatePolicy = duplicates;
+
+        // A directory or glob loads all matching shard files in parallel
+        if (isShardPattern(filename)) {
+            processUrlShards(graph, filename);
+        } else {
+            processUrlFile(graph, filename);
+        }
+    }
+    reorderGraph(graph, order);
+    compactUrls(graph);
+    if (compress) compressGraph(graph);
+    buildReachability(graph);
+    if (updatesFile) processUpdateFile(graph, updatesFile);
+    if (cacheSize > 0) enablePathCache(graph, cacheSize);
+
+    // --timeout, --max-settled and --max-scanned apply to every query
+    QueryContext* queryLimits = hasQueryLimits(&limits) ? &limits : NULL;
+    flowOptions.context = queryLimits;
+
+    printf("\n");
+    printCommands();
+
+    while (1) {
+        printf("\n> ");
+        if (fgets(line, sizeof(line), stdin) == NULL) break;
+        line[strcspn(line, "\n")] = '\0';
+
+        char* command = strtok(line, " ");
+        char* first = strtok(NULL, " ");
+        char* second = strtok(NULL, " ");
+        char* third = strtok(NULL, " ");
+        if (!command) continue;
+
+        if (strcmp(command, "quit") == 0) {
+            break;
+        } else if (strcmp(command, "stats") == 0) {
+            if (graph->pathCache) printPathCacheStats(graph->pathCache);
+            if (graph->disk) printDiskCacheStats(graph->disk);
+            printMemoryStats(&graph->memory);
+        } else if (strcmp(command, "batch") == 0 && first) {
+            batchShortestPaths(graph, first, numThreads, &limits);
+        } else if (strcmp(command, "update") == 0 && first) {
+            processUpdateFile(graph, first);
+        } else if (strcmp(command, "flow") == 0 && second) {
+            runFlow(graph, first, second, &flowOptions);
+        } else if (strcmp(command, "path") == 0 && second) {
+            runPath(graph, first, second, queryLimits);
+        } else if (strcmp(command, "paths") == 0 && second) {
+            runPaths(graph, first, second, third ? atoi(third) : DEFAULT_PATH_COUNT, maxHops);
+        } else if (strcmp(command, "count") == 0 && second) {
+            runCount(graph, first, second, maxHops);
+        } else if (strcmp(command, "reach") == 0 && second) {
+            runReach(graph, first, second);
+        } else {
+            printf("Error: Unknown or incomplete command '%s'\n", command);
+            printCommands();
+        }
+    }
+
+    printMemoryStats(&graph->memory);
+    freeGraph(graph);
+    return 0;
+}
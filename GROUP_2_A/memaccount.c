@@ -0,0 +1,70 @@
+#include "memaccount.h"
+
+static const char* categoryNames[MEM_CATEGORIES] = {
+    "Adjacency", "URLs", "Residual", "Search state"
+};
+
+void initMemAccount(MemAccount* account, size_t budget) {
+    pthread_mutex_init(&account->lock, NULL);
+    account->budget = budget;
+    for (int c = 0; c < MEM_CATEGORIES; c++) {
+        account->current[c] = 0;
+        account->peak[c] = 0;
+    }
+    account->total = 0;
+    account->peakTotal = 0;
+}
+
+// Records bytes about to be allocated. Returns 0, recording nothing, when
+// that would take the total past the budget.
+int memReserve(MemAccount* account, MemCategory category, size_t bytes) {
+    pthread_mutex_lock(&account->lock);
+    if (account->budget && bytes > account->budget - account->total) {
+        pthread_mutex_unlock(&account->lock);
+        return 0;
+    }
+    account->current[category] += bytes;
+    account->total += bytes;
+    if (account->current[category] > account->peak[category]) {
+        account->peak[category] = account->current[category];
+    }
+    if (account->total > account->peakTotal) account->peakTotal = account->total;
+    pthread_mutex_unlock(&account->lock);
+    return 1;
+}
+
+void memRelease(MemAccount* account, MemCategory category, size_t bytes) {
+    pthread_mutex_lock(&account->lock);
+    if (bytes > account->current[category]) bytes = account->current[category];
+    account->current[category] -= bytes;
+    account->total -= bytes;
+    pthread_mutex_unlock(&account->lock);
+}
+
+// Bytes that can still be reserved, SIZE_MAX without a budget
+size_t memAvailable(MemAccount* account) {
+    pthread_mutex_lock(&account->lock);
+    size_t available = account->budget ? account->budget - account->total : SIZE_MAX;
+    pthread_mutex_unlock(&account->lock);
+    return available;
+}
+
+void printMemoryStats(MemAccount* account) {
+    pthread_mutex_lock(&account->lock);
+    printf("\n=== Memory Usage ===\n");
+    printf("%-14s %14s %14s\n", "Category", "Current", "Peak");
+    printf("----------------------------------------------\n");
+    for (int c = 0; c < MEM_CATEGORIES; c++) {
+        printf("%-14s %14zu %14zu\n", categoryNames[c], account->current[c], account->peak[c]);
+    }
+    printf("%-14s %14zu %14zu\n", "Total", account->total, account->peakTotal);
+    if (account->budget) {
+        printf("Budget: %zu bytes (%.1f%% of it used at peak)\n", account->budget,
+               100.0 * account->peakTotal / account->budget);
+    }
+    pthread_mutex_unlock(&account->lock);
+}
+
+void destroyMemAccount(MemAccount* account) {
+    pthread_mutex_destroy(&account->lock);
+}
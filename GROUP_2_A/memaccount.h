@@ -0,0 +1,36 @@
+#ifndef MEMACCOUNT_H
+#define MEMACCOUNT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+
+typedef enum MemCategory {
+    MEM_ADJACENCY,
+    MEM_URLS,
+    MEM_RESIDUAL,
+    MEM_SEARCH,
+    MEM_CATEGORIES
+} MemCategory;
+
+// Bytes held per category, with high-water marks. A non-zero budget caps
+// the total: memReserve refuses anything that would cross it, so callers
+// can fail or pick a leaner structure before allocating.
+typedef struct MemAccount {
+    pthread_mutex_t lock;
+    size_t budget;
+    size_t current[MEM_CATEGORIES];
+    size_t peak[MEM_CATEGORIES];
+    size_t total;
+    size_t peakTotal;
+} MemAccount;
+
+void initMemAccount(MemAccount* account, size_t budget);
+int memReserve(MemAccount* account, MemCategory category, size_t bytes);
+void memRelease(MemAccount* account, MemCategory category, size_t bytes);
+size_t memAvailable(MemAccount* account);
+void printMemoryStats(MemAccount* account);
+void destroyMemAccount(MemAccount* account);
+
+#endif
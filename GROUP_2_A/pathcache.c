@@ -0,0 +1,180 @@
+#include "pathcache.h"
+
+static int bucketOf(PathCache* cache, int source, int target) {
+    unsigned int h = (unsigned int)source * 2654435761u ^ (unsigned int)target * 40503u;
+    return (int)(h % (unsigned int)cache->numBuckets);
+}
+
+PathCache* createPathCache(int capacity) {
+    if (capacity <= 0) return NULL;
+
+    PathCache* cache = (PathCache*)calloc(1, sizeof(PathCache));
+    if (!cache) return NULL;
+    pthread_mutex_init(&cache->lock, NULL);
+    cache->capacity = capacity;
+    cache->numBuckets = capacity * 2 + 1;
+    cache->entries = (PathCacheEntry*)calloc(capacity, sizeof(PathCacheEntry));
+    cache->buckets = (int*)malloc(cache->numBuckets * sizeof(int));
+    if (!cache->entries || !cache->buckets) {
+        freePathCache(cache);
+        return NULL;
+    }
+    for (int b = 0; b < cache->numBuckets; b++) cache->buckets[b] = -1;
+    cache->head = -1;
+    cache->tail = -1;
+    return cache;
+}
+
+static void unlinkLru(PathCache* cache, int e) {
+    PathCacheEntry* entry = &cache->entries[e];
+    if (entry->prev != -1) cache->entries[entry->prev].next = entry->next;
+    else cache->head = entry->next;
+    if (entry->next != -1) cache->entries[entry->next].prev = entry->prev;
+    else cache->tail = entry->prev;
+}
+
+static void pushFront(PathCache* cache, int e) {
+    PathCacheEntry* entry = &cache->entries[e];
+    entry->prev = -1;
+    entry->next = cache->head;
+    if (cache->head != -1) cache->entries[cache->head].prev = e;
+    cache->head = e;
+    if (cache->tail == -1) cache->tail = e;
+}
+
+static void unlinkBucket(PathCache* cache, int e) {
+    PathCacheEntry* entry = &cache->entries[e];
+    int* link = &cache->buckets[bucketOf(cache, entry->source, entry->target)];
+    while (*link != e) link = &cache->entries[*link].hashNext;
+    *link = entry->hashNext;
+}
+
+// Removes e and moves the last slot into its place so entries stay dense
+static void removeEntry(PathCache* cache, int e) {
+    unlinkBucket(cache, e);
+    unlinkLru(cache, e);
+    free(cache->entries[e].path);
+
+    int last = --cache->count;
+    if (e == last) return;
+
+    PathCacheEntry* moved = &cache->entries[last];
+    int* link = &cache->buckets[bucketOf(cache, moved->source, moved->target)];
+    while (*link != last) link = &cache->entries[*link].hashNext;
+    *link = e;
+    if (moved->prev != -1) cache->entries[moved->prev].next = e;
+    else cache->head = e;
+    if (moved->next != -1) cache->entries[moved->next].prev = e;
+    else cache->tail = e;
+    cache->entries[e] = *moved;
+}
+
+static int findEntry(PathCache* cache, int source, int target) {
+    int e = cache->buckets[bucketOf(cache, source, target)];
+    while (e != -1 && (cache->entries[e].source != source ||
+                       cache->entries[e].target != target)) {
+        e = cache->entries[e].hashNext;
+    }
+    return e;
+}
+
+static int lookupLocked(PathCache* cache, int source, int target, unsigned long version,
+                        int** path, int* length) {
+    int e = findEntry(cache, source, target);
+    if (e != -1 && cache->entries[e].version != version) {
+        removeEntry(cache, e);
+        cache->staleMisses++;
+        e = -1;
+    }
+    if (e == -1) {
+        cache->misses++;
+        return 0;
+    }
+
+    PathCacheEntry* entry = &cache->entries[e];
+    *length = entry->length;
+    *path = NULL;
+    if (entry->length > 0) {
+        *path = (int*)malloc(entry->length * sizeof(int));
+        if (!*path) return 0;
+        memcpy(*path, entry->path, entry->length * sizeof(int));
+        cache->hits++;
+    } else {
+        cache->negativeHits++;
+    }
+
+    unlinkLru(cache, e);
+    pushFront(cache, e);
+    return 1;
+}
+
+// Returns 1 on a hit. *path receives a copy the caller frees, or NULL
+// with *length 0 for a cached "no path" answer.
+int pathCacheLookup(PathCache* cache, int source, int target, unsigned long version,
+                    int** path, int* length) {
+    pthread_mutex_lock(&cache->lock);
+    int hit = lookupLocked(cache, source, target, version, path, length);
+    pthread_mutex_unlock(&cache->lock);
+    return hit;
+}
+
+void pathCacheStore(PathCache* cache, int source, int target, unsigned long version,
+                    const int* path, int length) {
+    int* copy = NULL;
+    if (length > 0) {
+        copy = (int*)malloc(length * sizeof(int));
+        if (!copy) return;
+        memcpy(copy, path, length * sizeof(int));
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    int e = findEntry(cache, source, target);
+    if (e != -1) {
+        removeEntry(cache, e);
+    } else if (cache->count == cache->capacity) {
+        removeEntry(cache, cache->tail);
+        cache->evictions++;
+    }
+
+    e = cache->count++;
+    PathCacheEntry* entry = &cache->entries[e];
+    entry->source = source;
+    entry->target = target;
+    entry->path = copy;
+    entry->length = length;
+    entry->version = version;
+
+    int b = bucketOf(cache, source, target);
+    entry->hashNext = cache->buckets[b];
+    cache->buckets[b] = e;
+    pushFront(cache, e);
+    pthread_mutex_unlock(&cache->lock);
+}
+
+void printPathCacheStats(PathCache* cache) {
+    pthread_mutex_lock(&cache->lock);
+    long lookups = cache->hits + cache->negativeHits + cache->misses;
+
+    printf("\n=== Path Cache ===\n");
+    printf("Entries: %d / %d\n", cache->count, cache->capacity);
+    printf("Lookups: %ld\n", lookups);
+    printf("Hits: %ld (negative: %ld)\n", cache->hits + cache->negativeHits, cache->negativeHits);
+    printf("Misses: %ld (stale after graph change: %ld)\n", cache->misses, cache->staleMisses);
+    printf("Evictions: %ld\n", cache->evictions);
+    if (lookups > 0) {
+        printf("Hit rate: %.1f%%\n",
+               100.0 * (cache->hits + cache->negativeHits) / lookups);
+    }
+    pthread_mutex_unlock(&cache->lock);
+}
+
+void freePathCache(PathCache* cache) {
+    if (!cache) return;
+    if (cache->entries) {
+        for (int e = 0; e < cache->count; e++) free(cache->entries[e].path);
+    }
+    free(cache->entries);
+    free(cache->buckets);
+    pthread_mutex_destroy(&cache->lock);
+    free(cache);
+}
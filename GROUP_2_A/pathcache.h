@@ -0,0 +1,49 @@
+#ifndef PATHCACHE_H
+#define PATHCACHE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+// Bounded LRU cache of shortest-path answers keyed by (source, target)
+// vertex ids. A stored length of 0 records that no path exists. Entries
+// remember the graph version they were computed against and are dropped
+// on lookup once the graph has changed. Lookups and stores lock the cache,
+// so searches running side by side under the graph's read lock may share it.
+typedef struct PathCacheEntry {
+    int source;
+    int target;
+    int* path;
+    int length;
+    unsigned long version;
+    int prev;
+    int next;
+    int hashNext;
+} PathCacheEntry;
+
+typedef struct PathCache {
+    PathCacheEntry* entries;
+    int capacity;
+    int count;
+    int* buckets;
+    int numBuckets;
+    int head;
+    int tail;
+    long hits;
+    long negativeHits;
+    long misses;
+    long staleMisses;
+    long evictions;
+    pthread_mutex_t lock;
+} PathCache;
+
+PathCache* createPathCache(int capacity);
+int pathCacheLookup(PathCache* cache, int source, int target, unsigned long version,
+                    int** path, int* length);
+void pathCacheStore(PathCache* cache, int source, int target, unsigned long version,
+                    const int* path, int length);
+void printPathCacheStats(PathCache* cache);
+void freePathCache(PathCache* cache);
+
+#endif
@@ -0,0 +1,95 @@
+#include "querycontext.h"
+#include <string.h>
+
+void initQueryContext(QueryContext* ctx) {
+    ctx->deadlineSeconds = 0;
+    ctx->maxSettled = 0;
+    ctx->maxScanned = 0;
+    ctx->cancelled = 0;
+    ctx->sharedCancel = NULL;
+    ctx->status = QUERY_OK;
+    ctx->settled = 0;
+    ctx->scanned = 0;
+    ctx->started.tv_sec = 0;
+    ctx->started.tv_nsec = 0;
+}
+
+// Reads --timeout=MS, --max-settled=N or --max-scanned=N into ctx.
+// Returns 1 if arg was one of them.
+int parseQueryLimit(const char* arg, QueryContext* ctx) {
+    if (strncmp(arg, "--timeout=", 10) == 0) {
+        ctx->deadlineSeconds = atof(arg + 10) / 1000.0;
+    } else if (strncmp(arg, "--max-settled=", 14) == 0) {
+        ctx->maxSettled = atol(arg + 14);
+    } else if (strncmp(arg, "--max-scanned=", 14) == 0) {
+        ctx->maxScanned = atol(arg + 14);
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+int hasQueryLimits(const QueryContext* ctx) {
+    return ctx->deadlineSeconds > 0 || ctx->maxSettled > 0 || ctx->maxScanned > 0;
+}
+
+// Resets the counters and starts the clock; a cancel issued before the
+// query starts still counts
+void startQuery(QueryContext* ctx) {
+    ctx->status = QUERY_OK;
+    ctx->settled = 0;
+    ctx->scanned = 0;
+    clock_gettime(CLOCK_MONOTONIC, &ctx->started);
+}
+
+// Starts ctx with the limits of parent, which stays the one to cancel:
+// a cancelQuery on parent stops ctx too
+void startChildQuery(QueryContext* ctx, const QueryContext* parent) {
+    *ctx = *parent;
+    ctx->cancelled = 0;
+    ctx->sharedCancel = &parent->cancelled;
+    startQuery(ctx);
+}
+
+double queryElapsed(const QueryContext* ctx) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - ctx->started.tv_sec) + (now.tv_nsec - ctx->started.tv_nsec) / 1e9;
+}
+
+// Returns 1 and records why once the query has to stop. The counters are
+// plain compares; the clock is only read when a deadline is set.
+int queryExpired(QueryContext* ctx) {
+    if (!ctx) return 0;
+    if (ctx->status != QUERY_OK) return 1;
+
+    if (__atomic_load_n(&ctx->cancelled, __ATOMIC_RELAXED) ||
+        (ctx->sharedCancel && __atomic_load_n(ctx->sharedCancel, __ATOMIC_RELAXED))) {
+        ctx->status = QUERY_CANCELLED;
+    } else if ((ctx->maxSettled && ctx->settled >= ctx->maxSettled) ||
+               (ctx->maxScanned && ctx->scanned >= ctx->maxScanned)) {
+        ctx->status = QUERY_LIMIT_REACHED;
+    } else if (ctx->deadlineSeconds > 0 && queryElapsed(ctx) >= ctx->deadlineSeconds) {
+        ctx->status = QUERY_TIMED_OUT;
+    }
+    return ctx->status != QUERY_OK;
+}
+
+void cancelQuery(QueryContext* ctx) {
+    __atomic_store_n(&ctx->cancelled, 1, __ATOMIC_RELAXED);
+}
+
+const char* queryStatusName(QueryStatus status) {
+    switch (status) {
+        case QUERY_OK: return "completed";
+        case QUERY_TIMED_OUT: return "timed out";
+        case QUERY_CANCELLED: return "cancelled";
+        case QUERY_LIMIT_REACHED: return "hit its work limit";
+    }
+    return "unknown";
+}
+
+void printQueryStopped(const QueryContext* ctx) {
+    printf("Query %s after %.3f s (%ld vertices settled, %ld edges scanned)\n",
+           queryStatusName(ctx->status), queryElapsed(ctx), ctx->settled, ctx->scanned);
+}
@@ -0,0 +1,42 @@
+#ifndef QUERYCONTEXT_H
+#define QUERYCONTEXT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef enum QueryStatus {
+    QUERY_OK,
+    QUERY_TIMED_OUT,
+    QUERY_CANCELLED,
+    QUERY_LIMIT_REACHED
+} QueryStatus;
+
+// Limits for one query. Zero limits mean unlimited. The query counts what
+// it settles and scans and polls the limits at its frontier or
+// augmentation boundaries; once one trips it stops and reports status
+// instead of an answer. cancelQuery may be called from any thread.
+typedef struct QueryContext {
+    double deadlineSeconds;
+    long maxSettled;        // vertices taken off a frontier
+    long maxScanned;        // edges or matrix cells examined
+    int cancelled;
+    const int* sharedCancel;    // a parent's cancelled flag, polled too
+    QueryStatus status;
+    long settled;
+    long scanned;
+    struct timespec started;
+} QueryContext;
+
+void initQueryContext(QueryContext* ctx);
+int parseQueryLimit(const char* arg, QueryContext* ctx);
+int hasQueryLimits(const QueryContext* ctx);
+void startQuery(QueryContext* ctx);
+void startChildQuery(QueryContext* ctx, const QueryContext* parent);
+int queryExpired(QueryContext* ctx);
+void cancelQuery(QueryContext* ctx);
+double queryElapsed(const QueryContext* ctx);
+const char* queryStatusName(QueryStatus status);
+void printQueryStopped(const QueryContext* ctx);
+
+#endif
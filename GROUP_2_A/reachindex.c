@@ -0,0 +1,216 @@
+#include "reachindex.h"
+
+// Iterative Tarjan: the explicit call stack holds the vertices whose edge
+// lists are still being walked and nextEdge remembers where each one
+// stopped, so deep chains of links cannot overflow the C stack.
+static int findComponents(int n, const int* offsets, const int* dests,
+                          int* component, int* sizes) {
+    int* index = (int*)malloc(n * sizeof(int));
+    int* low = (int*)malloc(n * sizeof(int));
+    int* nextEdge = (int*)malloc(n * sizeof(int));
+    int* stack = (int*)malloc(n * sizeof(int));
+    int* calls = (int*)malloc(n * sizeof(int));
+    char* onStack = (char*)calloc(n, sizeof(char));
+    if (!index || !low || !nextEdge || !stack || !calls || !onStack) {
+        free(index);
+        free(low);
+        free(nextEdge);
+        free(stack);
+        free(calls);
+        free(onStack);
+        return -1;
+    }
+
+    for (int v = 0; v < n; v++) index[v] = -1;
+    int counter = 0, numComponents = 0, top = 0;
+
+    for (int root = 0; root < n; root++) {
+        if (index[root] != -1) continue;
+
+        int depth = 0;
+        index[root] = low[root] = counter++;
+        nextEdge[root] = offsets[root];
+        stack[top++] = root;
+        onStack[root] = 1;
+        calls[depth++] = root;
+
+        while (depth > 0) {
+            int u = calls[depth - 1];
+            if (nextEdge[u] < offsets[u + 1]) {
+                int v = dests[nextEdge[u]++];
+                if (index[v] == -1) {
+                    index[v] = low[v] = counter++;
+                    nextEdge[v] = offsets[v];
+                    stack[top++] = v;
+                    onStack[v] = 1;
+                    calls[depth++] = v;
+                } else if (onStack[v] && index[v] < low[u]) {
+                    low[u] = index[v];
+                }
+                continue;
+            }
+
+            depth--;
+            if (low[u] == index[u]) {
+                int v;
+                sizes[numComponents] = 0;
+                do {
+                    v = stack[--top];
+                    onStack[v] = 0;
+                    component[v] = numComponents;
+                    sizes[numComponents]++;
+                } while (v != u);
+                numComponents++;
+            }
+            if (depth > 0) {
+                int parent = calls[depth - 1];
+                if (low[u] < low[parent]) low[parent] = low[u];
+            }
+        }
+    }
+
+    free(index);
+    free(low);
+    free(nextEdge);
+    free(stack);
+    free(calls);
+    free(onStack);
+    return numComponents;
+}
+
+// Builds the index over a CSR adjacency; offsets has numVertices + 1 entries
+// and only the edges a search may actually follow should be passed in
+ReachIndex* buildReachIndex(int numVertices, const int* offsets, const int* dests,
+                            size_t maxBitsetBytes) {
+    int n = numVertices;
+    ReachIndex* index = (ReachIndex*)calloc(1, sizeof(ReachIndex));
+    int* sizes = (int*)malloc((n + 1) * sizeof(int));
+    if (!index || !sizes) {
+        free(index);
+        free(sizes);
+        return NULL;
+    }
+
+    index->numVertices = n;
+    index->component = (int*)malloc((n + 1) * sizeof(int));
+    if (!index->component) {
+        free(sizes);
+        freeReachIndex(index);
+        return NULL;
+    }
+    int c = findComponents(n, offsets, dests, index->component, sizes);
+    if (c < 0) {
+        free(sizes);
+        freeReachIndex(index);
+        return NULL;
+    }
+    index->numComponents = c;
+    for (int i = 0; i < c; i++) {
+        if (sizes[i] > index->largestComponent) index->largestComponent = sizes[i];
+    }
+
+    // Group vertices by component so the DAG can be walked in id order
+    int* start = (int*)calloc(c + 1, sizeof(int));
+    int* members = (int*)malloc((n + 1) * sizeof(int));
+    index->height = (int*)calloc(c + 1, sizeof(int));
+    index->depth = (int*)calloc(c + 1, sizeof(int));
+    if (!start || !members || !index->height || !index->depth) {
+        free(sizes);
+        free(start);
+        free(members);
+        freeReachIndex(index);
+        return NULL;
+    }
+    for (int i = 0; i < c; i++) start[i + 1] = start[i] + sizes[i];
+    for (int v = 0; v < n; v++) members[start[index->component[v]]++] = v;
+    for (int i = c; i > 0; i--) start[i] = start[i - 1];
+    start[0] = 0;
+    free(sizes);
+
+    index->wordsPerComponent = (c + 63) / 64;
+    if ((size_t)c * index->wordsPerComponent * sizeof(unsigned long long) <=
+        maxBitsetBytes) {
+        index->reach = (unsigned long long*)calloc(
+            (size_t)c * index->wordsPerComponent + 1, sizeof(unsigned long long));
+    }
+
+    //sinks first: successors are always finished before their predecessors
+    for (int cu = 0; cu < c; cu++) {
+        unsigned long long* row = index->reach ?
+            index->reach + (size_t)cu * index->wordsPerComponent : NULL;
+        if (row) row[cu / 64] |= 1ULL << (cu % 64);
+
+        for (int m = start[cu]; m < start[cu + 1]; m++) {
+            int u = members[m];
+            for (int e = offsets[u]; e < offsets[u + 1]; e++) {
+                int cv = index->component[dests[e]];
+                if (cv == cu) continue;
+                if (index->height[cv] + 1 > index->height[cu]) {
+                    index->height[cu] = index->height[cv] + 1;
+                }
+                if (row) {
+                    const unsigned long long* other =
+                        index->reach + (size_t)cv * index->wordsPerComponent;
+                    for (int w = 0; w < index->wordsPerComponent; w++) row[w] |= other[w];
+                }
+            }
+        }
+    }
+
+    //roots first for the depth pass
+    for (int cu = c - 1; cu >= 0; cu--) {
+        for (int m = start[cu]; m < start[cu + 1]; m++) {
+            int u = members[m];
+            for (int e = offsets[u]; e < offsets[u + 1]; e++) {
+                int cv = index->component[dests[e]];
+                if (cv != cu && index->depth[cu] + 1 > index->depth[cv]) {
+                    index->depth[cv] = index->depth[cu] + 1;
+                }
+            }
+        }
+    }
+
+    free(start);
+    free(members);
+    return index;
+}
+
+// Returns 0 when no path from source to target can exist. With bitsets the
+// answer is exact; without them 1 only means the filters could not rule
+// the pair out.
+int reachIndexMayReach(const ReachIndex* index, int source, int target) {
+    if (source == target) return 1;
+    if (source < 0 || target < 0 ||
+        source >= index->numVertices || target >= index->numVertices) return 0;
+
+    int cs = index->component[source];
+    int ct = index->component[target];
+    if (cs == ct) return 1;
+    if (cs < ct) return 0;
+    if (index->height[cs] <= index->height[ct]) return 0;
+    if (index->depth[ct] <= index->depth[cs]) return 0;
+    if (index->reach) {
+        const unsigned long long* row = index->reach + (size_t)cs * index->wordsPerComponent;
+        return (row[ct / 64] >> (ct % 64)) & 1;
+    }
+    return 1;
+}
+
+size_t reachIndexBytes(const ReachIndex* index) {
+    size_t bytes = sizeof(ReachIndex) + (size_t)index->numVertices * sizeof(int) +
+                   2 * (size_t)index->numComponents * sizeof(int);
+    if (index->reach) {
+        bytes += (size_t)index->numComponents * index->wordsPerComponent *
+                 sizeof(unsigned long long);
+    }
+    return bytes;
+}
+
+void freeReachIndex(ReachIndex* index) {
+    if (!index) return;
+    free(index->component);
+    free(index->height);
+    free(index->depth);
+    free(index->reach);
+    free(index);
+}
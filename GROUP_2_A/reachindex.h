@@ -0,0 +1,32 @@
+#ifndef REACHINDEX_H
+#define REACHINDEX_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Default cap on the component-to-component bitsets; above the cap given
+// to buildReachIndex queries fall back to the level filters alone
+#define REACH_BITSET_MAX_BYTES (16 << 20)
+
+// Strongly connected components and a summary of the condensation DAG.
+// Tarjan emits components sinks first, so every condensation edge goes
+// from a higher component id to a lower one.
+typedef struct ReachIndex {
+    int numVertices;
+    int numComponents;
+    int largestComponent;
+    int* component;
+    int* height;            // longest condensation path down to a sink
+    int* depth;             // longest condensation path down from a root
+    int wordsPerComponent;
+    unsigned long long* reach;
+} ReachIndex;
+
+ReachIndex* buildReachIndex(int numVertices, const int* offsets, const int* dests,
+                            size_t maxBitsetBytes);
+int reachIndexMayReach(const ReachIndex* index, int source, int target);
+size_t reachIndexBytes(const ReachIndex* index);
+void freeReachIndex(ReachIndex* index);
+
+#endif
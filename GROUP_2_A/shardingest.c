@@ -0,0 +1,387 @@
+#include <dirent.h>
+#include <glob.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "shardingest.h"
+
+// One partition of the intern table: URLs are stored densely in insertion
+// order and found through an open-addressing table of local indices
+typedef struct UrlPartition {
+    pthread_mutex_t lock;
+    char** urls;
+    unsigned long long* hashes;
+    long long* firstSeen;
+    int count;
+    int capacity;
+    int* table;
+    int tableSize;
+} UrlPartition;
+
+// Edges of one shard with partition-local URL ids
+typedef struct ShardEdges {
+    int* src;
+    int* dest;
+    int* weight;
+    int numEdges;
+    int capacity;
+    long numLines;
+} ShardEdges;
+
+typedef struct IngestContext {
+    char** paths;
+    int numPaths;
+    int nextPath;
+    pthread_mutex_t nextLock;
+    UrlPartition partitions[SHARD_PARTITIONS];
+    ShardEdges* shards;
+    int maxUrlLength;
+    int failed;
+} IngestContext;
+
+int isShardPattern(const char* path) {
+    struct stat st;
+    if (strpbrk(path, "*?[")) return 1;
+    return stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+static int comparePaths(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+// Regular files of a directory, or the matches of a glob, sorted by path
+static int expandShardPaths(const char* pattern, char*** paths) {
+    struct stat st;
+    int count = 0;
+    *paths = NULL;
+
+    if (stat(pattern, &st) == 0 && S_ISDIR(st.st_mode)) {
+        DIR* dir = opendir(pattern);
+        if (!dir) return -1;
+        int capacity = 0;
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != NULL) {
+            char path[4096];
+            snprintf(path, sizeof(path), "%s/%s", pattern, entry->d_name);
+            if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) continue;
+            if (count == capacity) {
+                capacity = capacity ? capacity * 2 : 16;
+                char** grown = (char**)realloc(*paths, capacity * sizeof(char*));
+                if (!grown) break;
+                *paths = grown;
+            }
+            (*paths)[count++] = strdup(path);
+        }
+        closedir(dir);
+    } else {
+        glob_t matches;
+        if (glob(pattern, 0, NULL, &matches) != 0) return 0;
+        *paths = (char**)malloc((matches.gl_pathc + 1) * sizeof(char*));
+        for (size_t i = 0; *paths && i < matches.gl_pathc; i++) {
+            if (stat(matches.gl_pathv[i], &st) == 0 && S_ISREG(st.st_mode)) {
+                (*paths)[count++] = strdup(matches.gl_pathv[i]);
+            }
+        }
+        globfree(&matches);
+    }
+
+    if (count > 1) qsort(*paths, count, sizeof(char*), comparePaths);
+    return count;
+}
+
+static unsigned long long hashUrl(const char* url) {
+    unsigned long long hash = 14695981039346656037ULL;
+    for (; *url; url++) {
+        hash ^= (unsigned char)*url;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static int growPartition(UrlPartition* part) {
+    int capacity = part->capacity ? part->capacity * 2 : 64;
+    char** urls = (char**)realloc(part->urls, capacity * sizeof(char*));
+    if (!urls) return 0;
+    part->urls = urls;
+    unsigned long long* hashes = (unsigned long long*)realloc(part->hashes,
+        capacity * sizeof(unsigned long long));
+    if (!hashes) return 0;
+    part->hashes = hashes;
+    long long* firstSeen = (long long*)realloc(part->firstSeen, capacity * sizeof(long long));
+    if (!firstSeen) return 0;
+    part->firstSeen = firstSeen;
+    part->capacity = capacity;
+
+    //rehash into a table twice the entry capacity
+    int tableSize = capacity * 2;
+    int* table = (int*)malloc(tableSize * sizeof(int));
+    if (!table) return 0;
+    for (int i = 0; i < tableSize; i++) table[i] = -1;
+    for (int e = 0; e < part->count; e++) {
+        int slot = (int)((part->hashes[e] >> 6) & (tableSize - 1));
+        while (table[slot] != -1) slot = (slot + 1) & (tableSize - 1);
+        table[slot] = e;
+    }
+    free(part->table);
+    part->table = table;
+    part->tableSize = tableSize;
+    return 1;
+}
+
+// Returns the id of url as partition + SHARD_PARTITIONS * local index,
+// interning it if needed and keeping the earliest position it was seen at
+static int internUrl(IngestContext* ctx, const char* url, long long seenAt) {
+    unsigned long long hash = hashUrl(url);
+    int p = (int)(hash % SHARD_PARTITIONS);
+    UrlPartition* part = &ctx->partitions[p];
+    int id = -1;
+
+    pthread_mutex_lock(&part->lock);
+    if (part->tableSize > 0) {
+        int slot = (int)((hash >> 6) & (part->tableSize - 1));
+        for (; part->table[slot] != -1; slot = (slot + 1) & (part->tableSize - 1)) {
+            int e = part->table[slot];
+            if (part->hashes[e] == hash && strcmp(part->urls[e], url) == 0) {
+                if (seenAt < part->firstSeen[e]) part->firstSeen[e] = seenAt;
+                id = e;
+                break;
+            }
+        }
+    }
+    if (id == -1 && (part->count < part->capacity || growPartition(part))) {
+        id = part->count++;
+        part->urls[id] = strdup(url);
+        part->hashes[id] = hash;
+        part->firstSeen[id] = seenAt;
+        int slot = (int)((hash >> 6) & (part->tableSize - 1));
+        while (part->table[slot] != -1) slot = (slot + 1) & (part->tableSize - 1);
+        part->table[slot] = id;
+    }
+    pthread_mutex_unlock(&part->lock);
+
+    return id == -1 ? -1 : p + SHARD_PARTITIONS * id;
+}
+
+static int shardEdgeAdd(ShardEdges* shard, int src, int dest, int weight) {
+    if (shard->numEdges == shard->capacity) {
+        int capacity = shard->capacity ? shard->capacity * 2 : 256;
+        int* newSrc = (int*)realloc(shard->src, capacity * sizeof(int));
+        if (!newSrc) return 0;
+        shard->src = newSrc;
+        int* newDest = (int*)realloc(shard->dest, capacity * sizeof(int));
+        if (!newDest) return 0;
+        shard->dest = newDest;
+        int* newWeight = (int*)realloc(shard->weight, capacity * sizeof(int));
+        if (!newWeight) return 0;
+        shard->weight = newWeight;
+        shard->capacity = capacity;
+    }
+    shard->src[shard->numEdges] = src;
+    shard->dest[shard->numEdges] = dest;
+    shard->weight[shard->numEdges] = weight;
+    shard->numEdges++;
+    return 1;
+}
+
+// Same line format and clean-up as processUrlFile
+static int parseShard(IngestContext* ctx, int shardIndex) {
+    FILE* file = fopen(ctx->paths[shardIndex], "r");
+    if (!file) {
+        printf("Error: Cannot open file '%s'\n", ctx->paths[shardIndex]);
+        return 0;
+    }
+
+    ShardEdges* shard = &ctx->shards[shardIndex];
+    char line[8192];
+    long lineNo = 0;
+    while (fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        lineNo++;
+
+        char* saveptr;
+        char* fromUrl = strtok_r(line, ",", &saveptr);
+        char* toUrl = strtok_r(NULL, ",", &saveptr);
+        char* weightToken = strtok_r(NULL, ",", &saveptr);
+        if (!fromUrl || !toUrl || !weightToken) continue;
+
+        if ((int)strlen(fromUrl) >= ctx->maxUrlLength) fromUrl[ctx->maxUrlLength - 1] = '\0';
+        if ((int)strlen(toUrl) >= ctx->maxUrlLength) toUrl[ctx->maxUrlLength - 1] = '\0';
+        int weight = abs(atoi(weightToken));
+
+        // Position key: shard, then line, then source before destination
+        long long seenAt = ((long long)shardIndex << 40) | ((long long)lineNo << 1);
+        int src = internUrl(ctx, fromUrl, seenAt);
+        int dest = internUrl(ctx, toUrl, seenAt | 1);
+        if (src == -1 || dest == -1 || !shardEdgeAdd(shard, src, dest, weight)) {
+            fclose(file);
+            return 0;
+        }
+    }
+    shard->numLines = lineNo;
+
+    fclose(file);
+    return 1;
+}
+
+static void* ingestWorker(void* arg) {
+    IngestContext* ctx = (IngestContext*)arg;
+    for (;;) {
+        pthread_mutex_lock(&ctx->nextLock);
+        int shardIndex = ctx->failed ? ctx->numPaths : ctx->nextPath++;
+        pthread_mutex_unlock(&ctx->nextLock);
+        if (shardIndex >= ctx->numPaths) break;
+
+        if (!parseShard(ctx, shardIndex)) {
+            pthread_mutex_lock(&ctx->nextLock);
+            ctx->failed = 1;
+            pthread_mutex_unlock(&ctx->nextLock);
+        }
+    }
+    return NULL;
+}
+
+typedef struct SeenKey {
+    long long firstSeen;
+    int id;
+} SeenKey;
+
+static int compareSeen(const void* a, const void* b) {
+    long long x = ((const SeenKey*)a)->firstSeen, y = ((const SeenKey*)b)->firstSeen;
+    return (x > y) - (x < y);
+}
+
+static void freeContext(IngestContext* ctx) {
+    for (int p = 0; p < SHARD_PARTITIONS; p++) {
+        UrlPartition* part = &ctx->partitions[p];
+        for (int e = 0; e < part->count; e++) free(part->urls[e]);
+        free(part->urls);
+        free(part->hashes);
+        free(part->firstSeen);
+        free(part->table);
+        pthread_mutex_destroy(&part->lock);
+    }
+    for (int i = 0; i < ctx->numPaths; i++) {
+        free(ctx->paths[i]);
+        if (ctx->shards) {
+            free(ctx->shards[i].src);
+            free(ctx->shards[i].dest);
+            free(ctx->shards[i].weight);
+        }
+    }
+    free(ctx->paths);
+    free(ctx->shards);
+    pthread_mutex_destroy(&ctx->nextLock);
+}
+
+// Parses every shard matched by pattern (a directory or a glob) on up to
+// numThreads threads (0 = one per core), then renumbers URLs by first
+// appearance and concatenates the edges in shard order
+ShardIngest* ingestShards(const char* pattern, int maxUrlLength, int numThreads) {
+    IngestContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.maxUrlLength = maxUrlLength;
+    pthread_mutex_init(&ctx.nextLock, NULL);
+    for (int p = 0; p < SHARD_PARTITIONS; p++) {
+        pthread_mutex_init(&ctx.partitions[p].lock, NULL);
+    }
+
+    ctx.numPaths = expandShardPaths(pattern, &ctx.paths);
+    if (ctx.numPaths <= 0) {
+        printf("Error: No shard files match '%s'\n", pattern);
+        if (ctx.numPaths < 0) ctx.numPaths = 0;
+        freeContext(&ctx);
+        return NULL;
+    }
+    ctx.shards = (ShardEdges*)calloc(ctx.numPaths, sizeof(ShardEdges));
+    if (!ctx.shards) {
+        freeContext(&ctx);
+        return NULL;
+    }
+
+    if (numThreads <= 0) numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (numThreads <= 0) numThreads = 1;
+    if (numThreads > ctx.numPaths) numThreads = ctx.numPaths;
+
+    pthread_t threads[numThreads];
+    int started = 0;
+    for (int t = 1; t < numThreads; t++) {
+        if (pthread_create(&threads[t], NULL, ingestWorker, &ctx) != 0) break;
+        started = t;
+    }
+    ingestWorker(&ctx);
+    for (int t = 1; t <= started; t++) pthread_join(threads[t], NULL);
+    if (ctx.failed) {
+        printf("Error: Could not load all shards of '%s'\n", pattern);
+        freeContext(&ctx);
+        return NULL;
+    }
+
+    // Final ids follow first appearance, which does not depend on how the
+    // shards were scheduled
+    int numUrls = 0;
+    for (int p = 0; p < SHARD_PARTITIONS; p++) numUrls += ctx.partitions[p].count;
+    SeenKey* keys = (SeenKey*)malloc((numUrls + 1) * sizeof(SeenKey));
+    int* localStart = (int*)calloc(SHARD_PARTITIONS + 1, sizeof(int));
+    int* finalId = (int*)malloc((numUrls + 1) * sizeof(int));
+    ShardIngest* ingest = (ShardIngest*)calloc(1, sizeof(ShardIngest));
+    if (ingest) ingest->urls = (char**)malloc((numUrls + 1) * sizeof(char*));
+    if (!keys || !localStart || !finalId || !ingest || !ingest->urls) {
+        free(keys);
+        free(localStart);
+        free(finalId);
+        if (ingest) free(ingest->urls);
+        free(ingest);
+        freeContext(&ctx);
+        return NULL;
+    }
+
+    for (int p = 0; p < SHARD_PARTITIONS; p++) {
+        localStart[p + 1] = localStart[p] + ctx.partitions[p].count;
+        for (int e = 0; e < ctx.partitions[p].count; e++) {
+            keys[localStart[p] + e].firstSeen = ctx.partitions[p].firstSeen[e];
+            keys[localStart[p] + e].id = p + SHARD_PARTITIONS * e;
+        }
+    }
+    qsort(keys, numUrls, sizeof(SeenKey), compareSeen);
+    for (int i = 0; i < numUrls; i++) {
+        int p = keys[i].id % SHARD_PARTITIONS, e = keys[i].id / SHARD_PARTITIONS;
+        finalId[localStart[p] + e] = i;
+        ingest->urls[i] = ctx.partitions[p].urls[e];
+        ctx.partitions[p].urls[e] = NULL;
+    }
+
+    long numEdges = 0;
+    for (int i = 0; i < ctx.numPaths; i++) numEdges += ctx.shards[i].numEdges;
+    ingest->edges = createEdgeBuilder((int)numEdges);
+    ingest->numShards = ctx.numPaths;
+    ingest->numUrls = numUrls;
+    for (int i = 0; ingest->edges && i < ctx.numPaths; i++) {
+        ShardEdges* shard = &ctx.shards[i];
+        for (int j = 0; j < shard->numEdges; j++) {
+            int src = shard->src[j], dest = shard->dest[j];
+            edgeBuilderAdd(ingest->edges,
+                finalId[localStart[src % SHARD_PARTITIONS] + src / SHARD_PARTITIONS],
+                finalId[localStart[dest % SHARD_PARTITIONS] + dest / SHARD_PARTITIONS],
+                shard->weight[j]);
+        }
+        ingest->numLines += shard->numLines;
+    }
+
+    free(keys);
+    free(localStart);
+    free(finalId);
+    freeContext(&ctx);
+    if (!ingest->edges) {
+        freeShardIngest(ingest);
+        return NULL;
+    }
+    return ingest;
+}
+
+void freeShardIngest(ShardIngest* ingest) {
+    if (!ingest) return;
+    for (int i = 0; i < ingest->numUrls; i++) free(ingest->urls[i]);
+    free(ingest->urls);
+    freeEdgeBuilder(ingest->edges);
+    free(ingest);
+}
@@ -0,0 +1,28 @@
+#ifndef SHARDINGEST_H
+#define SHARDINGEST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "edgebuilder.h"
+
+// Number of independently locked partitions of the URL intern table
+#define SHARD_PARTITIONS 64
+
+// Result of loading a set of shard files. Vertex ids are assigned in the
+// order URLs first appear when the shards are read in sorted path order,
+// so the graph is the same as loading their concatenation, however the
+// work was split between threads.
+typedef struct ShardIngest {
+    int numShards;
+    long numLines;
+    int numUrls;
+    char** urls;
+    EdgeBuilder* edges;
+} ShardIngest;
+
+int isShardPattern(const char* path);
+ShardIngest* ingestShards(const char* pattern, int maxUrlLength, int numThreads);
+void freeShardIngest(ShardIngest* ingest);
+
+#endif
@@ -0,0 +1,175 @@
+#include "urldict.h"
+
+// A URL with its input position, so the sort needs no shared state
+typedef struct UrlKey {
+    const char* url;
+    int index;
+} UrlKey;
+
+static int compareUrlKey(const void* a, const void* b) {
+    return strcmp(((const UrlKey*)a)->url, ((const UrlKey*)b)->url);
+}
+
+static size_t putVarint(unsigned char* out, size_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (unsigned char)value;
+    return n;
+}
+
+static size_t getVarint(const unsigned char* in, size_t* value) {
+    size_t n = 0, shift = 0, result = 0;
+    while (in[n] & 0x80) {
+        result |= (size_t)(in[n++] & 0x7f) << shift;
+        shift += 7;
+    }
+    result |= (size_t)in[n++] << shift;
+    *value = result;
+    return n;
+}
+
+static size_t commonPrefix(const char* a, const char* b) {
+    size_t n = 0;
+    while (a[n] && a[n] == b[n]) n++;
+    return n;
+}
+
+// Builds the dictionary from distinct URLs. rankOf[i] receives the id of
+// urls[i]; the caller keeps that mapping, the dictionary only knows ranks.
+UrlDict* buildUrlDict(const char** urls, int numUrls, int* rankOf) {
+    UrlDict* dict = (UrlDict*)calloc(1, sizeof(UrlDict));
+    UrlKey* order = (UrlKey*)malloc((numUrls + 1) * sizeof(UrlKey));
+    size_t worstCase = 0;
+    for (int i = 0; i < numUrls; i++) {
+        worstCase += strlen(urls[i]) + 2 * sizeof(size_t);
+    }
+    if (dict) {
+        dict->numUrls = numUrls;
+        dict->numBlocks = (numUrls + URL_DICT_BLOCK - 1) / URL_DICT_BLOCK;
+        dict->blockOffsets = (size_t*)malloc((dict->numBlocks + 1) * sizeof(size_t));
+        dict->data = (unsigned char*)malloc(worstCase + 1);
+    }
+    if (!dict || !order || !dict->blockOffsets || !dict->data) {
+        free(order);
+        freeUrlDict(dict);
+        return NULL;
+    }
+
+    for (int i = 0; i < numUrls; i++) {
+        order[i].url = urls[i];
+        order[i].index = i;
+    }
+    qsort(order, numUrls, sizeof(UrlKey), compareUrlKey);
+
+    size_t pos = 0;
+    for (int r = 0; r < numUrls; r++) {
+        const char* url = order[r].url;
+        size_t length = strlen(url);
+        size_t shared = 0;
+
+        if (r % URL_DICT_BLOCK == 0) {
+            dict->blockOffsets[r / URL_DICT_BLOCK] = pos;
+        } else {
+            shared = commonPrefix(order[r - 1].url, url);
+            pos += putVarint(dict->data + pos, shared);
+        }
+        pos += putVarint(dict->data + pos, length - shared);
+        memcpy(dict->data + pos, url + shared, length - shared);
+        pos += length - shared;
+
+        if (rankOf) rankOf[order[r].index] = r;
+    }
+    dict->blockOffsets[dict->numBlocks] = pos;
+    dict->dataSize = pos;
+
+    // Give back the worst-case slack
+    unsigned char* shrunk = (unsigned char*)realloc(dict->data, pos + 1);
+    if (shrunk) dict->data = shrunk;
+
+    free(order);
+    return dict;
+}
+
+// Decodes block entries up to and including 'rank' into buf
+const char* urlDictGet(const UrlDict* dict, int rank, char* buf, size_t bufSize) {
+    if (rank < 0 || rank >= dict->numUrls || bufSize == 0) return NULL;
+
+    const unsigned char* p = dict->data + dict->blockOffsets[rank / URL_DICT_BLOCK];
+    size_t length = 0;
+    for (int r = rank - rank % URL_DICT_BLOCK; r <= rank; r++) {
+        size_t shared = 0, suffix;
+        if (r % URL_DICT_BLOCK != 0) p += getVarint(p, &shared);
+        p += getVarint(p, &suffix);
+        if (shared > length) shared = length;
+        size_t copy = suffix;
+        if (shared + copy >= bufSize) copy = (shared < bufSize - 1) ? bufSize - 1 - shared : 0;
+        memcpy(buf + shared, p, copy);
+        length = shared + copy;
+        p += suffix;
+    }
+    buf[length] = '\0';
+    return buf;
+}
+
+// Binary search over the block heads, then a front-coded scan inside
+// the one block that can hold the URL. Returns the rank or -1.
+int urlDictFind(const UrlDict* dict, const char* url) {
+    int lo = 0, hi = dict->numBlocks - 1, block = -1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        const unsigned char* p = dict->data + dict->blockOffsets[mid];
+        size_t length;
+        p += getVarint(p, &length);
+
+        size_t urlLength = strlen(url);
+        int cmp = memcmp(p, url, length < urlLength ? length : urlLength);
+        if (cmp == 0) cmp = (length > urlLength) - (length < urlLength);
+
+        if (cmp == 0) return mid * URL_DICT_BLOCK;
+        if (cmp < 0) {
+            block = mid;
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    if (block == -1) return -1;
+
+    char current[4096];
+    int first = block * URL_DICT_BLOCK;
+    int last = first + URL_DICT_BLOCK;
+    if (last > dict->numUrls) last = dict->numUrls;
+
+    const unsigned char* p = dict->data + dict->blockOffsets[block];
+    size_t length = 0;
+    for (int r = first; r < last; r++) {
+        size_t shared = 0, suffix;
+        if (r != first) p += getVarint(p, &shared);
+        p += getVarint(p, &suffix);
+        if (shared + suffix >= sizeof(current)) return -1;
+        memcpy(current + shared, p, suffix);
+        length = shared + suffix;
+        current[length] = '\0';
+        p += suffix;
+
+        int cmp = strcmp(current, url);
+        if (cmp == 0) return r;
+        if (cmp > 0) break;
+    }
+    return -1;
+}
+
+size_t urlDictBytes(const UrlDict* dict) {
+    return sizeof(UrlDict) + dict->dataSize + 1 +
+           (dict->numBlocks + 1) * sizeof(size_t);
+}
+
+void freeUrlDict(UrlDict* dict) {
+    if (!dict) return;
+    free(dict->blockOffsets);
+    free(dict->data);
+    free(dict);
+}
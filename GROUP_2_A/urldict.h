@@ -0,0 +1,27 @@
+#ifndef URLDICT_H
+#define URLDICT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Strings per front-coded block; the first one in each block is stored whole
+#define URL_DICT_BLOCK 16
+
+// Sorted URLs stored as (shared prefix length, suffix) against the
+// previous URL in the same block. Ids are ranks in sorted order.
+typedef struct UrlDict {
+    int numUrls;
+    int numBlocks;
+    size_t* blockOffsets;
+    unsigned char* data;
+    size_t dataSize;
+} UrlDict;
+
+UrlDict* buildUrlDict(const char** urls, int numUrls, int* rankOf);
+const char* urlDictGet(const UrlDict* dict, int rank, char* buf, size_t bufSize);
+int urlDictFind(const UrlDict* dict, const char* url);
+size_t urlDictBytes(const UrlDict* dict);
+void freeUrlDict(UrlDict* dict);
+
+#endif
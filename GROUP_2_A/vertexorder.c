@@ -0,0 +1,151 @@
+#include "vertexorder.h"
+
+typedef struct DegreeKey {
+    int vertex;
+    int degree;
+} DegreeKey;
+
+int parseVertexOrder(const char* name, VertexOrder* order) {
+    if (strcmp(name, "none") == 0) *order = ORDER_NONE;
+    else if (strcmp(name, "bfs") == 0) *order = ORDER_BFS;
+    else if (strcmp(name, "rcm") == 0) *order = ORDER_RCM;
+    else if (strcmp(name, "degree") == 0) *order = ORDER_DEGREE;
+    else return 0;
+    return 1;
+}
+
+static int totalDegree(EdgeList* list, int v) {
+    return (list->outOffsets[v + 1] - list->outOffsets[v]) +
+           (list->inOffsets[v + 1] - list->inOffsets[v]);
+}
+
+// Higher degree first, ties by id so the order is deterministic
+static int compareDegreeDesc(const void* a, const void* b) {
+    const DegreeKey* x = (const DegreeKey*)a;
+    const DegreeKey* y = (const DegreeKey*)b;
+    if (x->degree != y->degree) return y->degree - x->degree;
+    return x->vertex - y->vertex;
+}
+
+static int compareDegreeAsc(const void* a, const void* b) {
+    const DegreeKey* x = (const DegreeKey*)a;
+    const DegreeKey* y = (const DegreeKey*)b;
+    if (x->degree != y->degree) return x->degree - y->degree;
+    return x->vertex - y->vertex;
+}
+
+// Breadth-first sweep over the undirected version of the graph, starting
+// each component at 'starts' in order. With byDegree set, neighbours are
+// queued lowest degree first (Cuthill-McKee). Returns -1 if out of memory.
+static int sweep(EdgeList* list, const int* starts, int byDegree, int* sequence) {
+    int n = list->numVertices;
+    char* seen = (char*)calloc(n + 1, sizeof(char));
+    DegreeKey* batch = (DegreeKey*)malloc((n + 1) * sizeof(DegreeKey));
+    int rear = 0;
+    if (!seen || !batch) {
+        free(seen);
+        free(batch);
+        return -1;
+    }
+
+    for (int s = 0; s < n; s++) {
+        int start = starts[s];
+        if (seen[start]) continue;
+        seen[start] = 1;
+        int front = rear;
+        sequence[rear++] = start;
+
+        while (front < rear) {
+            int u = sequence[front++];
+            int count = 0;
+            for (int j = list->outOffsets[u]; j < list->outOffsets[u + 1]; j++) {
+                int v = list->outDest[j];
+                if (!seen[v]) {
+                    seen[v] = 1;
+                    batch[count].vertex = v;
+                    batch[count++].degree = totalDegree(list, v);
+                }
+            }
+            for (int j = list->inOffsets[u]; j < list->inOffsets[u + 1]; j++) {
+                int v = list->inSrc[j];
+                if (!seen[v]) {
+                    seen[v] = 1;
+                    batch[count].vertex = v;
+                    batch[count++].degree = totalDegree(list, v);
+                }
+            }
+            if (byDegree) qsort(batch, count, sizeof(DegreeKey), compareDegreeAsc);
+            for (int k = 0; k < count; k++) {
+                sequence[rear++] = batch[k].vertex;
+            }
+        }
+    }
+
+    free(seen);
+    free(batch);
+    return 0;
+}
+
+// Returns newId[oldId] for the requested strategy, or NULL on failure
+int* computeVertexOrder(EdgeList* list, VertexOrder order) {
+    int n = list->numVertices;
+    int* sequence = (int*)malloc((n + 1) * sizeof(int));
+    int* starts = (int*)calloc(n + 1, sizeof(int));
+    int* newId = (int*)malloc((n + 1) * sizeof(int));
+    DegreeKey* keys = (DegreeKey*)malloc((n + 1) * sizeof(DegreeKey));
+    if (!sequence || !starts || !newId || !keys) {
+        free(sequence);
+        free(starts);
+        free(newId);
+        free(keys);
+        return NULL;
+    }
+
+    for (int v = 0; v < n; v++) {
+        starts[v] = v;
+        keys[v].vertex = v;
+        keys[v].degree = totalDegree(list, v);
+    }
+
+    int status = 0;
+    switch (order) {
+        case ORDER_NONE:
+            for (int v = 0; v < n; v++) sequence[v] = v;
+            break;
+        case ORDER_BFS:
+            status = sweep(list, starts, 0, sequence);
+            break;
+        case ORDER_RCM:
+            // Peripheral-ish starts: each component begins at its lowest
+            // degree vertex, then the whole sequence is reversed
+            qsort(keys, n, sizeof(DegreeKey), compareDegreeAsc);
+            for (int v = 0; v < n; v++) starts[v] = keys[v].vertex;
+            status = sweep(list, starts, 1, sequence);
+            for (int i = 0, j = n - 1; i < j; i++, j--) {
+                int tmp = sequence[i];
+                sequence[i] = sequence[j];
+                sequence[j] = tmp;
+            }
+            break;
+        case ORDER_DEGREE:
+            qsort(keys, n, sizeof(DegreeKey), compareDegreeDesc);
+            for (int v = 0; v < n; v++) sequence[v] = keys[v].vertex;
+            break;
+    }
+    if (status < 0) {
+        free(sequence);
+        free(starts);
+        free(newId);
+        free(keys);
+        return NULL;
+    }
+
+    for (int i = 0; i < n; i++) {
+        newId[sequence[i]] = i;
+    }
+
+    free(sequence);
+    free(starts);
+    free(keys);
+    return newId;
+}
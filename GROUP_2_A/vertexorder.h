@@ -0,0 +1,20 @@
+#ifndef VERTEXORDER_H
+#define VERTEXORDER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "edgebuilder.h"
+
+// Relabeling strategies applied after a graph is loaded
+typedef enum VertexOrder {
+    ORDER_NONE,
+    ORDER_BFS,
+    ORDER_RCM,
+    ORDER_DEGREE
+} VertexOrder;
+
+int parseVertexOrder(const char* name, VertexOrder* order);
+int* computeVertexOrder(EdgeList* list, VertexOrder order);
+
+#endif